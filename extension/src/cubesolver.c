@@ -3,7 +3,11 @@
 #endif
 
 #include "solver/cubestate.h"
+#include "solver/ida_star.h"
+#include "solver/parallel_ida.h"
+#include "solver/patterndb.h"
 #include "solver/solver.h"
+#include "solver/twophase.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -53,8 +57,8 @@ bool export_solution(const char *filename, int move_count, Movement moves[static
 
 int main(int argc, char **argv) {
     // Check argument count.
-    if (argc != 3) {
-        printf("Usage: cubesolver [infile] [outfile]\n");
+    if (argc != 3 && argc != 4) {
+        printf("Usage: cubesolver [infile] [outfile] [pattern database directory]\n");
         return 0;
     }
 
@@ -65,7 +69,15 @@ int main(int argc, char **argv) {
     // Solve shuffled cube.
     int total_moves = 0;
     Movement solution[20] = { { .face = TOP, .direction = CW } };
-    solve(&main_state, &total_moves, solution);
+
+    // With pattern databases from pdbbuilder, find a shortest solution on every core. Otherwise any short one will do.
+    PatternHeuristic *patterns = argc == 4 ? load_korf_heuristic(argv[3]) : NULL;
+    if (patterns) {
+        parallel_ida_solve(&main_state, patterns, 0, &total_moves, solution);
+        free_pattern_heuristic(patterns);
+    } else {
+        twophase_solve(&main_state, &total_moves, solution);
+    }
 
     // Write output
     export_solution(argv[2], total_moves, solution);
@@ -82,10 +94,6 @@ bool load_in_file(const char *filename, CubeState *out_state) {
         return false;
     }
 
-    // Clear cube state.
-    out_state->history_count = 0;
-    memset(out_state->history, 0, sizeof(out_state->history));
-
     // Load file into cube state.
     for (int i = 0; i < FACES * SIDE_LENGTH; ++i) {
         fscanf(infile, "%hhu %hhu %hhu\n",
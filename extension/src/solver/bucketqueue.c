@@ -0,0 +1,119 @@
+#include "bucketqueue.h"
+
+#include <stdio.h>
+#include <string.h>
+
+MoveBucketQueue *new_move_bucket_queue(size_t initial_levels) {
+    MoveBucketQueue *queue = (MoveBucketQueue *) malloc(sizeof(MoveBucketQueue));
+    if (!queue) {
+        return NULL;
+    }
+
+    initial_levels = initial_levels ? initial_levels : 1u;
+    queue->buckets = (NodeBucket *) calloc(initial_levels * DEPTHS, sizeof(NodeBucket));
+    if (!queue->buckets) {
+        free(queue);
+        return NULL;
+    }
+
+    queue->levels = initial_levels;
+    queue->count = 0u;
+    queue->lowest = initial_levels;
+    queue->error = MQ_OK;
+
+    return queue;
+}
+
+bool free_move_bucket_queue(MoveBucketQueue *queue) {
+    if (!queue) {
+        return false;
+    }
+
+    for (size_t i = 0; i < queue->levels * DEPTHS; ++i) {
+        free(queue->buckets[i].nodes);
+    }
+    free(queue->buckets);
+    free(queue);
+
+    return true;
+}
+
+static bool extend_levels(MoveBucketQueue *queue, size_t cost) {
+    size_t new_levels = queue->levels + (queue->levels >> 1u) + 1u;
+    new_levels = (new_levels <= cost) ? cost + 1u : new_levels;
+
+    NodeBucket *new_buckets = (NodeBucket *) realloc(queue->buckets, new_levels * DEPTHS * sizeof(NodeBucket));
+    if (!new_buckets) {
+        return false;
+    }
+
+    memset(new_buckets + queue->levels * DEPTHS, 0, (new_levels - queue->levels) * DEPTHS * sizeof(NodeBucket));
+
+    queue->buckets = new_buckets;
+    queue->levels = new_levels;
+
+    return true;
+}
+
+static bool extend_bucket(NodeBucket *bucket) {
+    size_t new_size = bucket->size + (bucket->size >> 1u) + 4u;
+
+    MoveQueueNode *new_nodes = (MoveQueueNode *) realloc(bucket->nodes, new_size * sizeof(MoveQueueNode));
+    if (!new_nodes) {
+        return false;
+    }
+
+    bucket->nodes = new_nodes;
+    bucket->size = new_size;
+
+    return true;
+}
+
+bool add_to_move_bucket_queue(MoveBucketQueue *queue, const CubeState *state, PathLink link, unsigned int cost) {
+    if (cost >= queue->levels && !extend_levels(queue, cost)) {
+        queue->error = MQ_ALLOC_ERROR;
+        return false;
+    }
+
+    NodeBucket *bucket = &(queue->buckets[cost * DEPTHS + link.depth]);
+    if (bucket->count >= bucket->size && !extend_bucket(bucket)) {
+        queue->error = MQ_ALLOC_ERROR;
+        return false;
+    }
+
+    MoveQueueNode *node = &(bucket->nodes[bucket->count++]);
+    memcpy(&node->state, state, sizeof(CubeState));
+    node->link = link;
+    node->key = cubestate_key(state);
+    node->cost = cost;
+
+    if (cost < queue->lowest) {
+        queue->lowest = cost;
+    }
+    ++(queue->count);
+    queue->error = MQ_OK;
+
+    return true;
+}
+
+bool poll_move_bucket_queue(MoveBucketQueue *queue, MoveQueueNode *out_node) {
+    if (queue->count == 0u) {
+        queue->error = MQ_UNDERFLOW;
+        return false;
+    }
+
+    // The queue is not empty, so some bucket at or above the lowest cost has a node.
+    for (;; ++(queue->lowest)) {
+        NodeBucket *level = &(queue->buckets[queue->lowest * DEPTHS]);
+
+        for (int depth = DEPTHS - 1; depth >= 0; --depth) {
+            if (level[depth].count > 0u) {
+                memcpy(out_node, &(level[depth].nodes[--(level[depth].count)]), sizeof(MoveQueueNode));
+                --(queue->count);
+                queue->error = MQ_OK;
+
+                return true;
+            }
+        }
+    }
+}
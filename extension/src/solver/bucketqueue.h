@@ -0,0 +1,79 @@
+#ifndef __BUCKETQUEUE_H__
+#define __BUCKETQUEUE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "cubestate.h"
+#include "movequeue.h"
+#include "movetrail.h"
+
+// Number of depths a state can be queued at, from the start state to MAXIMUM_MOVEMENTS.
+#define DEPTHS (MAXIMUM_MOVEMENTS + 1)
+
+/**
+ * A stack of nodes sharing the same cost and depth.
+ */
+typedef struct {
+    size_t size;          /**< Size of the node array. */
+    size_t count;         /**< Number of nodes in this bucket. */
+    MoveQueueNode *nodes; /**< The internal node array. */
+} NodeBucket;
+
+/**
+ * A movement priority queue for integer costs, with one bucket for each cost and depth.
+ * Polling takes the lowest cost first, breaking ties toward the deepest state and then the most recently added.
+ *
+ * Unlike MovePriorityQueue, states are not tracked while queued, so a state added twice is polled twice.
+ * Callers should skip states they have already visited when polling.
+ */
+typedef struct {
+    size_t levels;        /**< Number of costs with buckets. */
+    size_t count;         /**< Number of nodes in this queue. */
+    size_t lowest;        /**< No bucket below this cost holds any nodes. */
+
+    NodeBucket *buckets;  /**< The buckets, indexed by cost * DEPTHS + depth. */
+    MoveQueueError error; /**< Error state of the queue. Check this after most operations. */
+} MoveBucketQueue;
+
+/**
+ * Create a new bucket queue with buckets for a given range of costs.
+ * The queue will add buckets as higher costs are added to it.
+ *
+ * @param  initial_levels Initial proposed number of costs, starting from zero.
+ * @return                A pointer to the new queue if successful. NULL otherwise.
+ */
+MoveBucketQueue *new_move_bucket_queue(size_t initial_levels);
+
+/**
+ * Free a bucket queue.
+ *
+ * @param  queue The queue to free.
+ * @return       If queue is NULL, return false. Returns true otherwise.
+ */
+bool free_move_bucket_queue(MoveBucketQueue *queue);
+
+/**
+ * Add a state with its cost to the queue.
+ *
+ * @param[out] queue Queue to add to.
+ * @param[in]  state Cube state to add.
+ * @param[in]  link  How the search reached the state. Its depth picks the bucket within the cost.
+ * @param[in]  cost  Cube state's movement cost.
+ * @return           If the addition is successful, returns true. Otherwise, returns false.
+ */
+bool add_to_move_bucket_queue(MoveBucketQueue *queue, const CubeState *state, PathLink link, unsigned int cost);
+
+/**
+ * Get the item with the lowest cost, preferring the deepest.
+ * This item will be removed from the queue.
+ *
+ * @param[in]  queue    Queue to poll.
+ * @param[out] out_node Output node to copy the information to.
+ * @return              True if queue was successfully polled. Returns false otherwise.
+ */
+bool poll_move_bucket_queue(MoveBucketQueue *queue, MoveQueueNode *out_node);
+
+#endif  // __BUCKETQUEUE_H__
@@ -1,10 +1,166 @@
 #include "cubestate.h"
+#include "movekernel.h"
+
 #include <string.h>
 #include <stdio.h>
 
 // 524287 * i == (i << 19) - i; allows optimisation.
 #define HASH_CONSTANT 524287ul
 
+/*
+ * Location of a single square on the cube.
+ */
+typedef struct {
+    UFace face;
+    uint8_t row;
+    uint8_t col;
+} Facelet;
+
+/*
+ * The squares of each corner position, in clockwise order starting from the TOP / BOTTOM square.
+ */
+static const Facelet CORNER_FACELETS[CORNERS][3] = {
+    { { TOP, 2, 2 }, { RIGHT, 0, 0 }, { FRONT, 0, 2 } },
+    { { TOP, 2, 0 }, { FRONT, 0, 0 }, { LEFT, 0, 2 } },
+    { { TOP, 0, 0 }, { LEFT, 0, 0 }, { BACK, 0, 2 } },
+    { { TOP, 0, 2 }, { BACK, 0, 0 }, { RIGHT, 0, 2 } },
+    { { BOTTOM, 0, 2 }, { FRONT, 2, 2 }, { RIGHT, 2, 0 } },
+    { { BOTTOM, 0, 0 }, { LEFT, 2, 2 }, { FRONT, 2, 0 } },
+    { { BOTTOM, 2, 0 }, { BACK, 2, 2 }, { LEFT, 2, 0 } },
+    { { BOTTOM, 2, 2 }, { RIGHT, 2, 2 }, { BACK, 2, 0 } }
+};
+
+/*
+ * The squares of each edge position, starting from the TOP / BOTTOM (or FRONT / BACK) square.
+ */
+static const Facelet EDGE_FACELETS[EDGES][2] = {
+    { { TOP, 1, 2 }, { RIGHT, 0, 1 } },
+    { { TOP, 2, 1 }, { FRONT, 0, 1 } },
+    { { TOP, 1, 0 }, { LEFT, 0, 1 } },
+    { { TOP, 0, 1 }, { BACK, 0, 1 } },
+    { { BOTTOM, 1, 2 }, { RIGHT, 2, 1 } },
+    { { BOTTOM, 0, 1 }, { FRONT, 2, 1 } },
+    { { BOTTOM, 1, 0 }, { LEFT, 2, 1 } },
+    { { BOTTOM, 2, 1 }, { BACK, 2, 1 } },
+    { { FRONT, 1, 2 }, { RIGHT, 1, 0 } },
+    { { FRONT, 1, 0 }, { LEFT, 1, 2 } },
+    { { BACK, 1, 2 }, { LEFT, 1, 0 } },
+    { { BACK, 1, 0 }, { RIGHT, 1, 2 } }
+};
+
+/*
+ * Cubie movement tables, indexed by movement_index.
+ * Entry i of a permutation is the position whose cubie replaces the cubie at position i.
+ * The twists and flips are added to the orientation of the cubie that is moved into position i.
+ */
+static const uint8_t CORNER_MOVE_PERMUTATIONS[MOVES][CORNERS] = {
+    // TOP: CW, DOUBLE, CCW
+    { 3, 0, 1, 2, 4, 5, 6, 7 },
+    { 2, 3, 0, 1, 4, 5, 6, 7 },
+    { 1, 2, 3, 0, 4, 5, 6, 7 },
+    // FRONT: CW, DOUBLE, CCW
+    { 1, 5, 2, 3, 0, 4, 6, 7 },
+    { 5, 4, 2, 3, 1, 0, 6, 7 },
+    { 4, 0, 2, 3, 5, 1, 6, 7 },
+    // LEFT: CW, DOUBLE, CCW
+    { 0, 2, 6, 3, 4, 1, 5, 7 },
+    { 0, 6, 5, 3, 4, 2, 1, 7 },
+    { 0, 5, 1, 3, 4, 6, 2, 7 },
+    // BACK: CW, DOUBLE, CCW
+    { 0, 1, 3, 7, 4, 5, 2, 6 },
+    { 0, 1, 7, 6, 4, 5, 3, 2 },
+    { 0, 1, 6, 2, 4, 5, 7, 3 },
+    // RIGHT: CW, DOUBLE, CCW
+    { 4, 1, 2, 0, 7, 5, 6, 3 },
+    { 7, 1, 2, 4, 3, 5, 6, 0 },
+    { 3, 1, 2, 7, 0, 5, 6, 4 },
+    // BOTTOM: CW, DOUBLE, CCW
+    { 0, 1, 2, 3, 5, 6, 7, 4 },
+    { 0, 1, 2, 3, 6, 7, 4, 5 },
+    { 0, 1, 2, 3, 7, 4, 5, 6 }
+};
+
+static const uint8_t CORNER_MOVE_TWISTS[MOVES][CORNERS] = {
+    // TOP: CW, DOUBLE, CCW
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    // FRONT: CW, DOUBLE, CCW
+    { 1, 2, 0, 0, 2, 1, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 1, 2, 0, 0, 2, 1, 0, 0 },
+    // LEFT: CW, DOUBLE, CCW
+    { 0, 1, 2, 0, 0, 2, 1, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 2, 0, 0, 2, 1, 0 },
+    // BACK: CW, DOUBLE, CCW
+    { 0, 0, 1, 2, 0, 0, 2, 1 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 1, 2, 0, 0, 2, 1 },
+    // RIGHT: CW, DOUBLE, CCW
+    { 2, 0, 0, 1, 1, 0, 0, 2 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 2, 0, 0, 1, 1, 0, 0, 2 },
+    // BOTTOM: CW, DOUBLE, CCW
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+
+static const uint8_t EDGE_MOVE_PERMUTATIONS[MOVES][EDGES] = {
+    // TOP: CW, DOUBLE, CCW
+    { 3, 0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11 },
+    { 2, 3, 0, 1, 4, 5, 6, 7, 8, 9, 10, 11 },
+    { 1, 2, 3, 0, 4, 5, 6, 7, 8, 9, 10, 11 },
+    // FRONT: CW, DOUBLE, CCW
+    { 0, 9, 2, 3, 4, 8, 6, 7, 1, 5, 10, 11 },
+    { 0, 5, 2, 3, 4, 1, 6, 7, 9, 8, 10, 11 },
+    { 0, 8, 2, 3, 4, 9, 6, 7, 5, 1, 10, 11 },
+    // LEFT: CW, DOUBLE, CCW
+    { 0, 1, 10, 3, 4, 5, 9, 7, 8, 2, 6, 11 },
+    { 0, 1, 6, 3, 4, 5, 2, 7, 8, 10, 9, 11 },
+    { 0, 1, 9, 3, 4, 5, 10, 7, 8, 6, 2, 11 },
+    // BACK: CW, DOUBLE, CCW
+    { 0, 1, 2, 11, 4, 5, 6, 10, 8, 9, 3, 7 },
+    { 0, 1, 2, 7, 4, 5, 6, 3, 8, 9, 11, 10 },
+    { 0, 1, 2, 10, 4, 5, 6, 11, 8, 9, 7, 3 },
+    // RIGHT: CW, DOUBLE, CCW
+    { 8, 1, 2, 3, 11, 5, 6, 7, 4, 9, 10, 0 },
+    { 4, 1, 2, 3, 0, 5, 6, 7, 11, 9, 10, 8 },
+    { 11, 1, 2, 3, 8, 5, 6, 7, 0, 9, 10, 4 },
+    // BOTTOM: CW, DOUBLE, CCW
+    { 0, 1, 2, 3, 5, 6, 7, 4, 8, 9, 10, 11 },
+    { 0, 1, 2, 3, 6, 7, 4, 5, 8, 9, 10, 11 },
+    { 0, 1, 2, 3, 7, 4, 5, 6, 8, 9, 10, 11 }
+};
+
+static const uint8_t EDGE_MOVE_FLIPS[MOVES][EDGES] = {
+    // TOP: CW, DOUBLE, CCW
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    // FRONT: CW, DOUBLE, CCW
+    { 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 },
+    // LEFT: CW, DOUBLE, CCW
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    // BACK: CW, DOUBLE, CCW
+    { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 },
+    // RIGHT: CW, DOUBLE, CCW
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    // BOTTOM: CW, DOUBLE, CCW
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+
 uint64_t hash_cubestate(const CubeState *state) {
     uint64_t hash = 1ul;
     uint64_t multiplier = 1ul;
@@ -21,6 +177,26 @@ uint64_t hash_cubestate(const CubeState *state) {
     return hash;
 }
 
+StateKey cubestate_key(const CubeState *state) {
+    uint64_t halves[2] = { 0u, 0u };
+
+    for (size_t f = 0; f < FACES; ++f) {
+        uint64_t *half = &halves[f / (FACES / 2)];
+
+        for (size_t r = 0; r < SIDE_LENGTH; ++r) {
+            for (size_t c = 0; c < SIDE_LENGTH; ++c) {
+                // Centres never move, so leave them out to fit each half in 64 bits.
+                if (r == SIDE_LENGTH / 2 && c == SIDE_LENGTH / 2) {
+                    continue;
+                }
+                *half = *half * COLOURS + state->data[f][r][c];
+            }
+        }
+    }
+
+    return (StateKey) { .high = halves[0], .low = halves[1] };
+}
+
 UnfoldTemplate get_template_of(Face face) {
     switch (face) {
         case FRONT:
@@ -96,6 +272,21 @@ void project(UnfoldedFace source, UnfoldedFace target) {
 }
 
 CubeState apply_movement(CubeState *state, Movement movement) {
+    CubeState moved;
+    apply_movement_to_faces(state, movement, &moved);
+
+    return moved;
+}
+
+void apply_movement_to_faces(const CubeState *state, Movement movement, CubeState *out) {
+    move_facelets((const UColour *) state->data, movement, (UColour *) out->data);
+}
+
+void apply_all_movements_to_faces(const CubeState *state, CubeState out[static MOVES]) {
+    move_facelets_all((const UColour *) state->data, (UColour *) out[0].data, sizeof(CubeState));
+}
+
+CubeState apply_movement_by_unfolding(CubeState *state, Movement movement) {
     UnfoldedFace uf;
     unfold(movement.face, state, uf);
     rotate(uf, movement.direction);
@@ -106,13 +297,147 @@ CubeState apply_movement(CubeState *state, Movement movement) {
     unfold(movement.face, &moved, target_uf);
     project(uf, target_uf);
 
-    // Update move history
-    moved.history[moved.history_count] = movement;
-    moved.history_count++;
+    return moved;
+}
+
+bool cubies_from_state(const CubeState *state, CubieState *out) {
+    // Find which face each colour belongs to from the centres.
+    UFace face_of[COLOURS];
+    memset(face_of, FACES, sizeof(face_of));
+
+    for (UFace f = 0; f < FACES; ++f) {
+        UColour centre = state->data[f][1][1];
+        if (centre >= COLOURS || face_of[centre] != FACES) {
+            return false;
+        }
+        face_of[centre] = f;
+    }
+
+    unsigned used = 0u;
+    for (size_t pos = 0; pos < CORNERS; ++pos) {
+        UFace faces[3];
+        size_t twist = 3;
+
+        for (size_t k = 0; k < 3; ++k) {
+            const Facelet *facelet = &CORNER_FACELETS[pos][k];
+            UColour colour = state->data[facelet->face][facelet->row][facelet->col];
+            if (colour >= COLOURS) {
+                return false;
+            }
+
+            faces[k] = face_of[colour];
+            if (faces[k] == TOP || faces[k] == BOTTOM) {
+                twist = k;
+            }
+        }
+
+        if (twist == 3) {
+            return false;
+        }
+
+        // The TOP / BOTTOM square of the cubie lies on square `twist` of the position.
+        size_t cubie = 0;
+        for (; cubie < CORNERS; ++cubie) {
+            if (CORNER_FACELETS[cubie][0].face == faces[twist]
+                && CORNER_FACELETS[cubie][1].face == faces[(twist + 1) % 3]
+                && CORNER_FACELETS[cubie][2].face == faces[(twist + 2) % 3]) {
+                break;
+            }
+        }
+
+        if (cubie == CORNERS || (used & (1u << cubie))) {
+            return false;
+        }
+
+        used |= 1u << cubie;
+        out->corners[pos] = PackCorner(cubie, twist);
+    }
+
+    used = 0u;
+    for (size_t pos = 0; pos < EDGES; ++pos) {
+        UFace faces[2];
+
+        for (size_t k = 0; k < 2; ++k) {
+            const Facelet *facelet = &EDGE_FACELETS[pos][k];
+            UColour colour = state->data[facelet->face][facelet->row][facelet->col];
+            if (colour >= COLOURS) {
+                return false;
+            }
+
+            faces[k] = face_of[colour];
+        }
+
+        size_t cubie = 0, flip = 0;
+        for (; cubie < EDGES; ++cubie) {
+            if (EDGE_FACELETS[cubie][0].face == faces[0] && EDGE_FACELETS[cubie][1].face == faces[1]) {
+                flip = 0;
+                break;
+            } else if (EDGE_FACELETS[cubie][0].face == faces[1] && EDGE_FACELETS[cubie][1].face == faces[0]) {
+                flip = 1;
+                break;
+            }
+        }
+
+        if (cubie == EDGES || (used & (1u << cubie))) {
+            return false;
+        }
+
+        used |= 1u << cubie;
+        out->edges[pos] = PackEdge(cubie, flip);
+    }
+
+    return true;
+}
+
+void state_from_cubies(const CubieState *cubies, const UColour centres[static FACES], CubeState *out) {
+    for (size_t f = 0; f < FACES; ++f) {
+        out->data[f][1][1] = centres[f];
+    }
+
+    for (size_t pos = 0; pos < CORNERS; ++pos) {
+        size_t cubie = CornerCubie(cubies->corners[pos]);
+        size_t twist = CornerTwist(cubies->corners[pos]);
+
+        for (size_t k = 0; k < 3; ++k) {
+            const Facelet *facelet = &CORNER_FACELETS[pos][k];
+            UFace colour_face = CORNER_FACELETS[cubie][(k + 3 - twist) % 3].face;
+            out->data[facelet->face][facelet->row][facelet->col] = centres[colour_face];
+        }
+    }
+
+    for (size_t pos = 0; pos < EDGES; ++pos) {
+        size_t cubie = EdgeCubie(cubies->edges[pos]);
+        size_t flip = EdgeFlip(cubies->edges[pos]);
+
+        for (size_t k = 0; k < 2; ++k) {
+            const Facelet *facelet = &EDGE_FACELETS[pos][k];
+            UFace colour_face = EDGE_FACELETS[cubie][k ^ flip].face;
+            out->data[facelet->face][facelet->row][facelet->col] = centres[colour_face];
+        }
+    }
+}
+
+CubieState apply_cubie_movement(const CubieState *state, Movement movement) {
+    size_t move = movement_index(movement);
+    CubieState moved;
+
+    for (size_t i = 0; i < CORNERS; ++i) {
+        uint8_t from = state->corners[CORNER_MOVE_PERMUTATIONS[move][i]];
+        moved.corners[i] = PackCorner(CornerCubie(from), (CornerTwist(from) + CORNER_MOVE_TWISTS[move][i]) % 3);
+    }
+
+    for (size_t i = 0; i < EDGES; ++i) {
+        uint8_t from = state->edges[EDGE_MOVE_PERMUTATIONS[move][i]];
+        moved.edges[i] = from ^ PackEdge(0, EDGE_MOVE_FLIPS[move][i]);
+    }
 
     return moved;
 }
 
+bool cubies_solved(const CubieState *cubies) {
+    return memcmp(cubies, &SOLVED_CUBIES, sizeof(CubieState)) == 0;
+}
+
 bool solved(const CubeState *state) {
     static const int REQUIRED_COLOUR_COUNTS = SIDE_LENGTH * SIDE_LENGTH;
     int found_colours[COLOURS] = { 0 };
@@ -179,6 +504,5 @@ void printCubeState(const CubeState *state) {
         }
         printf("},\n");
     }
-    printf("move_count = %ld\n most_recent_move = %u, %u\n", state->history_count, state->history[state->history_count - 1].direction, state->history[state->history_count - 1].face);
 }
 
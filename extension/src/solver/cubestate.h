@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * Colours present on cube.
@@ -67,26 +68,190 @@ typedef struct {
 } Movement;
 
 /**
- * The current state of a cube, and the set of moves it took to get here.
+ * The current state of a cube.
+ * The moves taken to reach a state are tracked by the search engines, not by the state itself.
  */
 typedef struct {
-    FaceData data;                       /**< What the faces look like. */
-
-    size_t history_count;                /**< How much of the history is filled. */
-    Movement history[MAXIMUM_MOVEMENTS]; /**< The rotation history. */
+    FaceData data; /**< What the faces look like. */
 } CubeState;
 
+#define FACELETS (FACES * SIDE_LENGTH * SIDE_LENGTH)
+
+#define CORNERS 8
+#define EDGES   12
+#define MOVES   18
+
+/**
+ * Corner cubie positions, named by their faces in clockwise order.
+ * The first face named is always the TOP or BOTTOM face.
+ */
+typedef enum {
+    TOP_RIGHT_FRONT = 0,
+    TOP_FRONT_LEFT = 1,
+    TOP_LEFT_BACK = 2,
+    TOP_BACK_RIGHT = 3,
+    BOTTOM_FRONT_RIGHT = 4,
+    BOTTOM_LEFT_FRONT = 5,
+    BOTTOM_BACK_LEFT = 6,
+    BOTTOM_RIGHT_BACK = 7
+} Corner;
+
+/**
+ * Edge cubie positions.
+ * The first face named is the TOP or BOTTOM face, or the FRONT or BACK face for the middle layer.
+ */
+typedef enum {
+    TOP_RIGHT = 0,
+    TOP_FRONT = 1,
+    TOP_LEFT = 2,
+    TOP_BACK = 3,
+    BOTTOM_RIGHT = 4,
+    BOTTOM_FRONT = 5,
+    BOTTOM_LEFT = 6,
+    BOTTOM_BACK = 7,
+    FRONT_RIGHT = 8,
+    FRONT_LEFT = 9,
+    BACK_LEFT = 10,
+    BACK_RIGHT = 11
+} Edge;
+
+// A corner is packed as its cubie in the low 3 bits and its twist (0-2) above them.
+#define PackCorner(cubie, twist) ((uint8_t) ((cubie) | ((twist) << 3)))
+#define CornerCubie(corner)      ((corner) & 7)
+#define CornerTwist(corner)      ((corner) >> 3)
+
+// An edge is packed as its cubie in the low 4 bits and its flip (0-1) above them.
+#define PackEdge(cubie, flip) ((uint8_t) ((cubie) | ((flip) << 4)))
+#define EdgeCubie(edge)       ((edge) & 15)
+#define EdgeFlip(edge)        ((edge) >> 4)
+
+/**
+ * The cube described by which cubie sits in each corner and edge position, and how it is turned.
+ * Entry i describes the cubie that has replaced the cubie which belongs in position i.
+ */
+typedef struct {
+    uint8_t corners[CORNERS]; /**< Packed corner cubies, see PackCorner. */
+    uint8_t edges[EDGES];     /**< Packed edge cubies, see PackEdge. */
+} CubieState;
+
+/**
+ * Get the index (0 to MOVES - 1) of a movement, ordered by face and then by direction.
+ *
+ * @param  movement Movement to index.
+ * @return          The movement's index.
+ */
+static inline size_t movement_index(Movement movement) {
+    return movement.face * 3u + movement.direction;
+}
+
+/**
+ * Get the movement for an index given by movement_index.
+ *
+ * @param  index Index of the movement.
+ * @return       The movement at that index.
+ */
+static inline Movement movement_from_index(size_t index) {
+    // Clear the unused bits too, so movements can be compared bytewise.
+    Movement movement;
+    memset(&movement, 0, sizeof(Movement));
+
+    movement.face = index / 3u;
+    movement.direction = index % 3u;
+
+    return movement;
+}
+
+// Bitmask of the movements of one face, indexed by movement_index.
+#define FaceMoves(face) (UINT32_C(7) << (3u * (face)))
+#define ALL_MOVES       ((UINT32_C(1) << MOVES) - 1u)
+
+/**
+ * Movements worth taking after a movement of each face, as bitmasks indexed by movement_index.
+ * Entry FACES is for the start state, where every movement is allowed.
+ *
+ * Turning the same face twice in a row is never needed, and opposite faces commute,
+ * so those may only be turned in one order: the face with the lower number first.
+ */
+static const uint32_t CANONICAL_MOVES[FACES + 1] = {
+    [TOP]    = ALL_MOVES & ~FaceMoves(TOP),
+    [FRONT]  = ALL_MOVES & ~FaceMoves(FRONT),
+    [LEFT]   = ALL_MOVES & ~FaceMoves(LEFT),
+    [BACK]   = ALL_MOVES & ~(FaceMoves(BACK) | FaceMoves(FRONT)),
+    [RIGHT]  = ALL_MOVES & ~(FaceMoves(RIGHT) | FaceMoves(LEFT)),
+    [BOTTOM] = ALL_MOVES & ~(FaceMoves(BOTTOM) | FaceMoves(TOP)),
+    [FACES]  = ALL_MOVES
+};
+
 /**
  * Apply a movement to a cube state.
  *
  * @param[in] state     State to move from.
  * @param[in]  movement Movement to apply.
- * @return              A new struct containing the modified state with an updated move history.
+ * @return              A new struct containing the modified state.
  */
 CubeState apply_movement(CubeState *state, Movement movement);
 
+/**
+ * Apply a movement to a cube state in place of an existing state, using the precomputed movement tables.
+ *
+ * @param[in]  state    State to move from.
+ * @param[in]  movement Movement to apply.
+ * @param[out] out      State to write the moved state to. Must not be state.
+ */
+void apply_movement_to_faces(const CubeState *state, Movement movement, CubeState *out);
+
+/**
+ * Apply every movement to a cube state at once.
+ *
+ * @param[in]  state State to move from.
+ * @param[out] out   States to write the moved states to, indexed by movement_index.
+ */
+void apply_all_movements_to_faces(const CubeState *state, CubeState out[static MOVES]);
+
+/**
+ * Apply a movement to a cube state by unfolding and rotating the moved face.
+ * This is much slower than apply_movement, and is kept as a reference to check the movement tables against.
+ *
+ * @param[in] state    State to move from.
+ * @param[in] movement Movement to apply.
+ * @return             A new struct containing the modified state.
+ */
+CubeState apply_movement_by_unfolding(CubeState *state, Movement movement);
+
+/**
+ * An exact key for a cube state, packing the 48 non-centre facelets in base COLOURS, 24 to each half.
+ * Movements never move the centres, so within one search two states are equal exactly when their keys are.
+ */
+typedef struct {
+    uint64_t high; /**< Facelets of the TOP, FRONT and LEFT faces. */
+    uint64_t low;  /**< Facelets of the BACK, RIGHT and BOTTOM faces. */
+} StateKey;
+
+/**
+ * Get the exact key of a cube state.
+ *
+ * @param  state Cube state to key.
+ * @return       The key for the state's non-centre facelets.
+ */
+StateKey cubestate_key(const CubeState *state);
+
+/**
+ * Order two state keys.
+ *
+ * @param  a First key.
+ * @param  b Second key.
+ * @return   Negative if a is less than b, positive if a is greater than b, zero if they are equal.
+ */
+static inline int compare_state_keys(StateKey a, StateKey b) {
+    if (a.high != b.high) {
+        return (a.high > b.high) - (a.high < b.high);
+    }
+    return (a.low > b.low) - (a.low < b.low);
+}
+
 /**
  * Get the hash of a cube state.
+ * Different states may share a hash, so use cubestate_key where states must be told apart.
  *
  * @param  state Cube state to hash.
  * @return       A 64-bit unsigned hash for a cube state.
@@ -101,6 +266,42 @@ uint64_t hash_cubestate(const CubeState *state);
  */
 bool solved(const CubeState *state);
 
+/**
+ * Convert the face data of a cube state into its cubie representation.
+ * The colour of each face is taken from its centre square.
+ *
+ * @param[in]  state State to convert.
+ * @param[out] out   Cubie representation of the state.
+ * @return           True if every corner and edge has a valid set of colours.
+ */
+bool cubies_from_state(const CubeState *state, CubieState *out);
+
+/**
+ * Convert a cubie representation back into face data.
+ *
+ * @param[in]  cubies  Cubies to convert.
+ * @param[in]  centres Colour of each face's centre square.
+ * @param[out] out     State to write to.
+ */
+void state_from_cubies(const CubieState *cubies, const UColour centres[static FACES], CubeState *out);
+
+/**
+ * Apply a movement to a cubie representation.
+ *
+ * @param[in] state    Cubies to move from.
+ * @param[in] movement Movement to apply.
+ * @return             The moved cubies.
+ */
+CubieState apply_cubie_movement(const CubieState *state, Movement movement);
+
+/**
+ * Check whether a cubie representation is in solved position.
+ *
+ * @param  cubies Cubies to check.
+ * @return        True if solved.
+ */
+bool cubies_solved(const CubieState *cubies);
+
 /**
  * Print CubeState's face data.
  *
@@ -140,9 +341,7 @@ static const CubeState EXAMPLE_SOLVED_STATE = {
             { WHITE, WHITE, WHITE },
             { WHITE, WHITE, WHITE }
         }
-    },
-    .history_count = 0u,
-    .history = { { .face = TOP, .direction = CW } }
+    }
 };
 
 // One move away from solved
@@ -178,9 +377,7 @@ static const CubeState EXAMPLE_UNSOLVED_STATE = {
             { WHITE, WHITE, WHITE },
             { WHITE, WHITE, WHITE }
         }
-    },
-    .history_count = 0u,
-    .history = { { .face = TOP, .direction = CW } }
+    }
 };
 
 // scarmbled cube
@@ -216,9 +413,19 @@ static const CubeState EXAMPLE_SCRAMBLED_STATE = {
             { RED, YELLOW, YELLOW },
             { GREEN, ORANGE, BLUE }
         }
+    }
+};
+
+static const CubieState SOLVED_CUBIES = {
+    .corners = {
+        TOP_RIGHT_FRONT, TOP_FRONT_LEFT, TOP_LEFT_BACK, TOP_BACK_RIGHT,
+        BOTTOM_FRONT_RIGHT, BOTTOM_LEFT_FRONT, BOTTOM_BACK_LEFT, BOTTOM_RIGHT_BACK
     },
-    .history_count = 0u,
-    .history = { { .face = TOP, .direction = CW } }
+    .edges = {
+        TOP_RIGHT, TOP_FRONT, TOP_LEFT, TOP_BACK,
+        BOTTOM_RIGHT, BOTTOM_FRONT, BOTTOM_LEFT, BOTTOM_BACK,
+        FRONT_RIGHT, FRONT_LEFT, BACK_LEFT, BACK_RIGHT
+    }
 };
 
 /*
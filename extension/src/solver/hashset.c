@@ -0,0 +1,155 @@
+#include "hashset.h"
+
+#include <stdio.h>
+
+// Smallest slot array a set will use.
+#define MINIMUM_SLOTS 16u
+
+// Mix both halves of a key into a slot hash.
+static inline uint64_t hash_key(StateKey key) {
+    uint64_t hash = key.high ^ (key.low * UINT64_C(0x9e3779b97f4a7c15));
+
+    hash ^= hash >> 33u;
+    hash *= UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33u;
+    hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+    hash ^= hash >> 33u;
+
+    return hash;
+}
+
+static bool needs_growth(const HashSet *set, size_t count) {
+    return count * 4u >= set->size * 3u;
+}
+
+static SetEntry *new_entries(size_t size) {
+    SetEntry *entries = (SetEntry *) malloc(size * sizeof(SetEntry));
+    if (!entries) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        entries[i].queue_pos = EMPTY_SLOT;
+    }
+
+    return entries;
+}
+
+// Find the slot holding key, or the empty slot that ends its probe sequence.
+static SetEntry *probe(const HashSet *set, StateKey key) {
+    size_t mask = set->size - 1u;
+    size_t slot = hash_key(key) & mask;
+
+    while (set->entries[slot].queue_pos != EMPTY_SLOT
+            && compare_state_keys(set->entries[slot].key, key) != 0) {
+        slot = (slot + 1u) & mask;
+    }
+
+    return &(set->entries[slot]);
+}
+
+HashSet *new_hash_set(size_t initial_size) {
+    HashSet *set = (HashSet *) malloc(sizeof(HashSet));
+    if (!set) {
+        return NULL;
+    }
+
+    // Round up to a power of two with room for initial_size keys.
+    set->size = MINIMUM_SLOTS;
+    set->count = 0u;
+    while (needs_growth(set, initial_size)) {
+        set->size <<= 1u;
+    }
+
+    set->entries = new_entries(set->size);
+    if (!set->entries) {
+        free(set);
+        return NULL;
+    }
+
+    return set;
+}
+
+bool free_hash_set(HashSet *set) {
+    if (!set) {
+        return false;
+    }
+
+    free(set->entries);
+    free(set);
+
+    return true;
+}
+
+static bool grow_hash_set(HashSet *set) {
+    SetEntry *old_entries = set->entries;
+    size_t old_size = set->size;
+
+    SetEntry *entries = new_entries(old_size << 1u);
+    if (!entries) {
+        fprintf(stderr, "Failed to grow hash set to %zu slots.\n", old_size << 1u);
+        return false;
+    }
+
+    set->entries = entries;
+    set->size = old_size << 1u;
+
+    // Reinsert every key, keeping its queue offset.
+    for (size_t i = 0; i < old_size; ++i) {
+        if (old_entries[i].queue_pos != EMPTY_SLOT) {
+            *probe(set, old_entries[i].key) = old_entries[i];
+        }
+    }
+
+    free(old_entries);
+
+    return true;
+}
+
+bool add_to_hash_set(HashSet *set, StateKey key) {
+    SetEntry *entry = probe(set, key);
+
+    if (entry->queue_pos != EMPTY_SLOT) {
+        // Key is already in set.
+        return false;
+    }
+
+    if (needs_growth(set, set->count + 1u)) {
+        if (!grow_hash_set(set)) {
+            return false;
+        }
+        entry = probe(set, key);
+    }
+
+    entry->key = key;
+    entry->queue_pos = NOT_IN_QUEUE;
+    ++(set->count);
+
+    return true;
+}
+
+bool modify_offset_in_hash_set(HashSet *set, StateKey key, ssize_t where) {
+    SetEntry *entry = probe(set, key);
+
+    if (entry->queue_pos == EMPTY_SLOT) {
+        return false;
+    }
+
+    entry->queue_pos = where;
+
+    return true;
+}
+
+ssize_t *get_offset_from_hash_set(HashSet *set, const StateKey key) {
+    SetEntry *entry = probe(set, key);
+
+    if (entry->queue_pos >= 0) {
+        return &(entry->queue_pos);
+    } else {
+        return NULL;
+    }
+}
+
+bool query_hash_set(HashSet *set, const StateKey key) {
+    return probe(set, key)->queue_pos != EMPTY_SLOT;
+}
@@ -0,0 +1,89 @@
+#ifndef __HASHSET_H__
+#define __HASHSET_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "cubestate.h"
+
+// Queue offset of a slot that holds no key.
+#define EMPTY_SLOT   -2
+// Queue offset of a key whose state is not in a queue.
+#define NOT_IN_QUEUE -1
+
+/**
+ * A slot in a hash set.
+ */
+typedef struct {
+    StateKey key;      /**< Key identifying the slot's state. */
+    ssize_t queue_pos; /**< Index of where the state lives on the queue, NOT_IN_QUEUE, or EMPTY_SLOT. */
+} SetEntry;
+
+/**
+ * An open-addressing hash set of state keys, using linear probing.
+ * The slot array is a power of two in size, and doubles whenever it becomes three quarters full.
+ */
+typedef struct {
+    size_t size;       /**< Number of slots in the set. */
+    size_t count;      /**< Number of keys currently stored in the set. */
+    SetEntry *entries; /**< The internal slot array. */
+} HashSet;
+
+/**
+ * Allocate a new hash set. This set must be freed later using free_hash_set.
+ *
+ * @param  initial_size Initial proposed number of keys. The set will grow as keys are added to it.
+ * @return              If successful, the pointer to the new hash set. NULL otherwise.
+ */
+HashSet *new_hash_set(size_t initial_size);
+
+/**
+ * Free a hash set created by new_hash_set.
+ *
+ * @param  set The set to free.
+ * @return     If set is NULL, return false. Returns true otherwise.
+ */
+bool free_hash_set(HashSet *set);
+
+/**
+ * Add a state key to the set, with no queue offset.
+ * Failing to add a key does not free the set.
+ *
+ * @param[out] set Hash set to add key to.
+ * @param[in]  key Key to add.
+ * @return         True if key was sucessfully added. False if it was already present or the set could not grow.
+ */
+bool add_to_hash_set(HashSet *set, StateKey key);
+
+/**
+ * Modify a key's queue offset.
+ *
+ * @param[out] set   Hash set to modify offset in.
+ * @param[in]  key   Key to modify.
+ * @param[in]  where Offset in queue, or NOT_IN_QUEUE.
+ * @return           True if offset successfully modified. False if the key is not present.
+ */
+bool modify_offset_in_hash_set(HashSet *set, StateKey key, ssize_t where);
+
+/**
+ * Query a set for the queue offset associated with a key.
+ * The pointer is invalidated by the next key added to the set.
+ *
+ * @param  set The set to query.
+ * @param  key The key to find.
+ * @return     NULL if the key is not present or the queue offset is < 0. A valid pointer otherwise.
+ */
+ssize_t *get_offset_from_hash_set(HashSet *set, const StateKey key);
+
+/**
+ * Query a set for a key.
+ *
+ * @param  set The set to query.
+ * @param  key The key to find.
+ * @return     True if it is present.
+ */
+bool query_hash_set(HashSet *set, const StateKey key);
+
+#endif  // __HASHSET_H__
@@ -0,0 +1,419 @@
+#include "hda_star.h"
+#include "bucketqueue.h"
+#include "hashset.h"
+#include "movetrail.h"
+#include "solver.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Number of states sent to another thread in one push onto its inbox.
+#define BATCH_MESSAGES 64
+// Number of states a thread expands before looking at its inbox again.
+#define EXPANSIONS_PER_ROUND 64
+// Cost of the incumbent before any goal has been found.
+#define NO_INCUMBENT INT32_MAX
+
+// The movements which keep a cube in G1: any turn of the TOP and BOTTOM faces, and half turns of the rest.
+#define G1_MOVES (FaceMoves(TOP) | FaceMoves(BOTTOM)                                     \
+                  | UINT32_C(1) << (3u * FRONT + DOUBLE) | UINT32_C(1) << (3u * LEFT + DOUBLE) \
+                  | UINT32_C(1) << (3u * BACK + DOUBLE) | UINT32_C(1) << (3u * RIGHT + DOUBLE))
+
+/*
+ * A state sent to the thread that owns it, with how it was reached.
+ */
+typedef struct {
+    CubeState state;
+    PathLink link;
+} Message;
+
+/*
+ * Messages pushed onto an inbox together. Batches in an inbox form a stack through next.
+ */
+typedef struct MessageBatch_t {
+    struct MessageBatch_t *next;
+    size_t count;
+    Message messages[BATCH_MESSAGES];
+} MessageBatch;
+
+struct HDASearch_t;
+
+/*
+ * One thread, and the states it owns. Only inbox and idle are touched by other threads, atomically.
+ */
+typedef struct {
+    struct HDASearch_t *search;
+    int id;
+    MoveBucketQueue *open;
+    HashSet *closed;          /**< Key of each state expanded, with the fewest movements it was reached in. */
+    MoveTrail *trail;
+    MessageBatch **outboxes;  /**< Batch being filled for each thread, or NULL. */
+    MessageBatch *inbox;
+    int idle;
+} HDAWorker;
+
+/*
+ * Everything the threads share. Fields below lock are only touched while holding it.
+ */
+typedef struct HDASearch_t {
+    bool (*goal)(CubeState *state);
+    const Heuristic *heuristic;
+    uint32_t moves;
+    int threads;
+    HDAWorker *workers;
+
+    uint64_t sent;     /**< Number of messages pushed onto any inbox. */
+    uint64_t handled;  /**< Number of messages taken from an inbox and dealt with. */
+    int incumbent;     /**< Movements in the shortest solution found, or NO_INCUMBENT. */
+    int done;
+    int failed;
+
+    pthread_mutex_t lock;
+    PathLink goal_link;
+    CubeState goal_state;
+} HDASearch;
+
+// Pick the thread that owns a state.
+static int owner_of(const HDASearch *search, StateKey key) {
+    uint64_t hash = key.low ^ (key.high * UINT64_C(0x9e3779b97f4a7c15));
+
+    hash ^= hash >> 31u;
+    hash *= UINT64_C(0xbf58476d1ce4e5b9);
+    hash ^= hash >> 29u;
+
+    return (int) (hash % (uint64_t) search->threads);
+}
+
+static void fail(HDASearch *search) {
+    __atomic_store_n(&search->failed, 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&search->done, 1, __ATOMIC_SEQ_CST);
+}
+
+// Queue a state this thread owns, unless it has already been expanded through a path as short.
+static void receive(HDAWorker *worker, CubeState *state, PathLink link) {
+    ssize_t *depth = get_offset_from_hash_set(worker->closed, cubestate_key(state));
+    if (depth && *depth <= link.depth) {
+        return;
+    }
+
+    if (link.depth >= __atomic_load_n(&worker->search->incumbent, __ATOMIC_RELAXED)) {
+        // Already as long as the incumbent.
+        return;
+    }
+
+    int cost = link.depth + heuristic_estimate(worker->search->heuristic, state);
+    if (!add_to_move_bucket_queue(worker->open, state, link, cost)) {
+        fail(worker->search);
+    }
+}
+
+// Push a batch onto the inbox of the thread it is for.
+static void push_batch(HDAWorker *to, MessageBatch *batch) {
+    // Count the messages before they can be handled, so sent never trails handled.
+    __atomic_fetch_add(&to->search->sent, batch->count, __ATOMIC_SEQ_CST);
+
+    MessageBatch *head = __atomic_load_n(&to->inbox, __ATOMIC_RELAXED);
+    do {
+        batch->next = head;
+    } while (!__atomic_compare_exchange_n(&to->inbox, &head, batch, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static void send(HDAWorker *worker, int owner, const CubeState *state, PathLink link) {
+    MessageBatch *batch = worker->outboxes[owner];
+    if (!batch) {
+        batch = (MessageBatch *) malloc(sizeof(MessageBatch));
+        if (!batch) {
+            fail(worker->search);
+            return;
+        }
+        batch->count = 0;
+        worker->outboxes[owner] = batch;
+    }
+
+    batch->messages[batch->count].state = *state;
+    batch->messages[batch->count].link = link;
+    if (++batch->count == BATCH_MESSAGES) {
+        push_batch(&(worker->search->workers[owner]), batch);
+        worker->outboxes[owner] = NULL;
+    }
+}
+
+static void flush_outboxes(HDAWorker *worker) {
+    for (int owner = 0; owner < worker->search->threads; owner++) {
+        if (worker->outboxes[owner]) {
+            push_batch(&(worker->search->workers[owner]), worker->outboxes[owner]);
+            worker->outboxes[owner] = NULL;
+        }
+    }
+}
+
+// Take every batch in the inbox and queue its states.
+static bool handle_inbox(HDAWorker *worker) {
+    MessageBatch *batch = __atomic_exchange_n(&worker->inbox, NULL, __ATOMIC_ACQUIRE);
+    if (!batch) {
+        return false;
+    }
+
+    // Busy before anything is counted as handled, so the search cannot be seen to be over meanwhile.
+    __atomic_store_n(&worker->idle, 0, __ATOMIC_SEQ_CST);
+    while (batch) {
+        MessageBatch *next = batch->next;
+        for (size_t i = 0; i < batch->count; i++) {
+            receive(worker, &(batch->messages[i].state), batch->messages[i].link);
+        }
+        __atomic_fetch_add(&worker->search->handled, batch->count, __ATOMIC_SEQ_CST);
+        free(batch);
+        batch = next;
+    }
+
+    return true;
+}
+
+// Record a goal, keeping it if it is the shortest so far.
+static void reach_goal(HDAWorker *worker, const MoveQueueNode *node) {
+    HDASearch *search = worker->search;
+
+    pthread_mutex_lock(&search->lock);
+    if (node->link.depth < search->incumbent) {
+        search->goal_link = node->link;
+        search->goal_state = node->state;
+        __atomic_store_n(&search->incumbent, node->link.depth, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&search->lock);
+}
+
+static void expand_next(HDAWorker *worker) {
+    HDASearch *search = worker->search;
+    MoveQueueNode node;
+
+    if (!poll_move_bucket_queue(worker->open, &node)) {
+        return;
+    }
+    if (node.link.depth >= __atomic_load_n(&search->incumbent, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    ssize_t *depth = get_offset_from_hash_set(worker->closed, node.key);
+    if (depth && *depth <= node.link.depth) {
+        // A copy of a state already expanded through a path at least as short.
+        return;
+    }
+    if (!depth && !add_to_hash_set(worker->closed, node.key)) {
+        fail(search);
+        return;
+    }
+    modify_offset_in_hash_set(worker->closed, node.key, node.link.depth);
+
+    if (search->goal(&(node.state))) {
+        reach_goal(worker, &node);
+        return;
+    }
+    if (node.cost >= __atomic_load_n(&search->incumbent, __ATOMIC_RELAXED) || node.link.depth == MAXIMUM_MOVEMENTS) {
+        // Estimated not to lead to a shorter solution than the incumbent.
+        return;
+    }
+
+    // Parents are named by their index in this thread's trail, and this thread's id.
+    PathLink link = { .parent = NO_PARENT, .depth = node.link.depth + 1 };
+    if (node.link.depth > 0) {
+        uint32_t index;
+        if (worker->trail->count >= (NO_PARENT - worker->id) / search->threads
+                || !add_to_move_trail(worker->trail, node.link, &index)) {
+            fail(search);
+            return;
+        }
+        link.parent = index * search->threads + worker->id;
+    }
+
+    CubeState next[MOVES];
+    uint32_t allowed = moves_after(node.link) & search->moves;
+    apply_all_movements_to_faces(&(node.state), next);
+    for (size_t move = 0; move < MOVES; move++) {
+        if (!(allowed >> move & 1u)) continue;
+
+        link.move = movement_from_index(move);
+        int owner = owner_of(search, cubestate_key(&next[move]));
+        if (owner == worker->id) {
+            receive(worker, &next[move], link);
+        } else {
+            send(worker, owner, &next[move], link);
+        }
+    }
+}
+
+// The search is over if every thread is idle and no message is in flight, with no message sent meanwhile.
+static void check_termination(HDASearch *search) {
+    uint64_t sent = __atomic_load_n(&search->sent, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&search->handled, __ATOMIC_SEQ_CST) != sent) {
+        return;
+    }
+    for (int id = 0; id < search->threads; id++) {
+        if (!__atomic_load_n(&(search->workers[id].idle), __ATOMIC_SEQ_CST)) {
+            return;
+        }
+    }
+    if (__atomic_load_n(&search->sent, __ATOMIC_SEQ_CST) == sent) {
+        __atomic_store_n(&search->done, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void *work(void *argument) {
+    HDAWorker *worker = (HDAWorker *) argument;
+    HDASearch *search = worker->search;
+
+    while (!__atomic_load_n(&search->done, __ATOMIC_SEQ_CST)) {
+        if (handle_inbox(worker)) {
+            continue;
+        }
+
+        if (worker->open->count > 0) {
+            __atomic_store_n(&worker->idle, 0, __ATOMIC_SEQ_CST);
+            for (int n = 0; n < EXPANSIONS_PER_ROUND && worker->open->count > 0; n++) {
+                expand_next(worker);
+            }
+            flush_outboxes(worker);
+            continue;
+        }
+
+        // Nothing left worth expanding here, though more may yet arrive.
+        flush_outboxes(worker);
+        __atomic_store_n(&worker->idle, 1, __ATOMIC_SEQ_CST);
+        check_termination(search);
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+static void free_workers(HDASearch *search, int count) {
+    for (int id = 0; id < count; id++) {
+        HDAWorker *worker = &(search->workers[id]);
+
+        free_move_bucket_queue(worker->open);
+        free_hash_set(worker->closed);
+        free_move_trail(worker->trail);
+        for (int owner = 0; worker->outboxes && owner < search->threads; owner++) {
+            free(worker->outboxes[owner]);
+        }
+        free(worker->outboxes);
+        while (worker->inbox) {
+            MessageBatch *next = worker->inbox->next;
+            free(worker->inbox);
+            worker->inbox = next;
+        }
+    }
+    free(search->workers);
+}
+
+// Walk back from the goal through the trails of whichever threads expanded each state.
+static int trace_solution(const HDASearch *search, PathLink link, Movement *solution) {
+    int move_count = link.depth;
+
+    for (int i = move_count - 1; i >= 0; --i) {
+        solution[i] = link.move;
+
+        if (link.parent != NO_PARENT) {
+            link = search->workers[link.parent % search->threads].trail->links[link.parent / search->threads];
+        }
+    }
+
+    return move_count;
+}
+
+/*
+ * Search from start to a goal using the given movements, filling in the solution and the goal reached.
+ */
+static bool hda_search(CubeState *start, bool (*goal)(CubeState *state), const Heuristic *heuristic, uint32_t moves,
+                       int threads, int *move_count, Movement *solution, CubeState *reached) {
+    if (threads <= 0) {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = processors > 0 ? (int) processors : 1;
+    }
+
+    HDASearch search = {
+        .goal = goal,
+        .heuristic = heuristic,
+        .moves = moves,
+        .threads = threads,
+        .sent = 0u,
+        .handled = 0u,
+        .incumbent = NO_INCUMBENT,
+        .done = 0,
+        .failed = 0
+    };
+    search.workers = (HDAWorker *) calloc(threads, sizeof(HDAWorker));
+    if (!search.workers) {
+        return false;
+    }
+
+    for (int id = 0; id < threads; id++) {
+        HDAWorker *worker = &(search.workers[id]);
+        worker->search = &search;
+        worker->id = id;
+        worker->open = new_move_bucket_queue(2 * MAXIMUM_MOVEMENTS);
+        worker->closed = new_hash_set(100);
+        worker->trail = new_move_trail(100);
+        worker->outboxes = (MessageBatch **) calloc(threads, sizeof(MessageBatch *));
+        if (!worker->open || !worker->closed || !worker->trail || !worker->outboxes) {
+            free_workers(&search, id + 1);
+            return false;
+        }
+    }
+    pthread_mutex_init(&search.lock, NULL);
+
+    receive(&(search.workers[owner_of(&search, cubestate_key(start))]), start, START_LINK);
+
+    // The calling thread works as thread 0. Every thread owns some states, so all of them must start.
+    pthread_t *handles = (pthread_t *) malloc(threads * sizeof(pthread_t));
+    int started = 1;
+    while (handles && started < threads
+           && pthread_create(&handles[started], NULL, work, &(search.workers[started])) == 0) {
+        started++;
+    }
+    if (started < threads) {
+        fail(&search);
+    }
+    work(&(search.workers[0]));
+    for (int id = 1; id < started; id++) {
+        pthread_join(handles[id], NULL);
+    }
+    free(handles);
+
+    bool found = !search.failed && search.incumbent != NO_INCUMBENT;
+    if (found) {
+        *move_count = trace_solution(&search, search.goal_link, solution);
+        *reached = search.goal_state;
+    }
+
+    pthread_mutex_destroy(&search.lock);
+    free_workers(&search, threads);
+
+    return found;
+}
+
+static bool is_solved(CubeState *state) {
+    return solved(state);
+}
+
+bool hda_solve(CubeState *start, const Heuristic *heuristic, int threads, int *move_count, Movement *solution) {
+    CubeState reached;
+    return hda_search(start, is_solved, heuristic, ALL_MOVES, threads, move_count, solution, &reached);
+}
+
+CubeState hda_k_solve(CubeState *start, const Heuristic *heuristic, int threads, int *move_count,
+                      Movement *solution) {
+    CubeState reached;
+    if (!hda_search(start, within_g1, heuristic, ALL_MOVES, threads, move_count, solution, &reached)) {
+        return *start;
+    }
+    return reached;
+}
+
+bool hda_g1_solve(CubeState *start, const Heuristic *heuristic, int threads, int *move_count, Movement *solution) {
+    CubeState reached;
+    return hda_search(start, is_solved, heuristic, G1_MOVES, threads, move_count, solution, &reached);
+}
@@ -0,0 +1,63 @@
+#ifndef __HDA_STAR_H__
+#define __HDA_STAR_H__
+
+#include <stdbool.h>
+
+#include "cubestate.h"
+#include "heuristic.h"
+
+/*
+ * Hash distributed A*: the best-first searches of solver.h spread over several threads.
+ *
+ * Each state is owned by one thread, picked by a hash of its key. A thread keeps the open queue,
+ * visited set and move trail for the states it owns, and only it ever touches them. Children owned by
+ * another thread are batched up and pushed onto that thread's inbox, a lock-free stack which the owner
+ * takes whole. Links to parents name the trail of the thread that expanded them, so the solution is
+ * traced back across every trail once the search is over.
+ *
+ * A thread that finds a goal does not stop the search, since another thread may yet find a shorter
+ * path. Each goal becomes the incumbent if it is the shortest so far, and states estimated to cost at
+ * least the incumbent are not expanded. The search is over once every thread is idle, with nothing useful
+ * left to expand, and every message sent has been handled. With an admissible heuristic, such as
+ * patterns_heuristic gives, the incumbent is then a shortest solution.
+ */
+
+/**
+ * Finds a solution set of moves for a cube, as solve does, on several threads.
+ *
+ * @param[in]   start       The starting position.
+ * @param[in]   heuristic   Heuristic to estimate with, e.g. GREEDY_HEURISTIC as solve uses.
+ * @param[in]   threads     Number of threads, or 0 for one per online processor.
+ * @param[out]  move_count  The number of moves in the solution.
+ * @param[out]  solution    An array of moves which transform start to a solved cube.
+ * @return                  True if a solution was found.
+ */
+bool hda_solve(CubeState *start, const Heuristic *heuristic, int threads, int *move_count, Movement *solution);
+
+/**
+ * Finds a set of moves to put start into a position in G1, as k_solve does, on several threads.
+ *
+ * @param[in]   start       The starting position.
+ * @param[in]   heuristic   Heuristic to estimate with, e.g. GREEDY_HEURISTIC as k_solve uses.
+ * @param[in]   threads     Number of threads, or 0 for one per online processor.
+ * @param[out]  move_count  The number of moves in the solution.
+ * @param[out]  solution    An array of moves which transform start to a position in G1.
+ * @return                  The state in G1 that was reached, or start if none was.
+ */
+CubeState hda_k_solve(CubeState *start, const Heuristic *heuristic, int threads, int *move_count,
+                      Movement *solution);
+
+/**
+ * Finds a solution set of moves for a cube in G1, using only movements which stay in G1, on several threads.
+ * pre: start must be in G1.
+ *
+ * @param[in]   start       The starting position.
+ * @param[in]   heuristic   Heuristic to estimate the distance to solved with, e.g. GREEDY_HEURISTIC.
+ * @param[in]   threads     Number of threads, or 0 for one per online processor.
+ * @param[out]  move_count  The number of moves in the solution.
+ * @param[out]  solution    An array of moves which transform start to a solved cube.
+ * @return                  True if a solution was found.
+ */
+bool hda_g1_solve(CubeState *start, const Heuristic *heuristic, int threads, int *move_count, Movement *solution);
+
+#endif  // __HDA_STAR_H__
@@ -0,0 +1,266 @@
+#include "heuristic.h"
+#include "solver.h"
+
+#include <string.h>
+
+/**
+ * Entry in the registry of components.
+ */
+typedef struct {
+    const char *name;     /**< Name parse_heuristic reads. */
+    bool admissible;      /**< True if it never overestimates. */
+    bool counts_facelets; /**< True if it counts facelets face by face, false for PATTERN_COMPONENT. */
+    bool turn_invariant;  /**< True if turning a face keeps that face's count. */
+} ComponentEntry;
+
+// Face opposite each face.
+static const uint8_t OPPOSITE_FACES[FACES] = { BOTTOM, BACK, RIGHT, FRONT, LEFT, TOP };
+
+// Every face, in order.
+static const uint8_t ALL_FACES[FACES] = { TOP, FRONT, LEFT, BACK, RIGHT, BOTTOM };
+
+/**
+ * Faces whose counts a turn of each face can change: the four beside it, whose facelets it moves,
+ * then the turned face itself. The opposite face is left alone.
+ */
+static const uint8_t TURN_FACES[FACES][5] = {
+    { FRONT, LEFT, BACK, RIGHT, TOP },
+    { TOP, LEFT, RIGHT, BOTTOM, FRONT },
+    { TOP, FRONT, BACK, BOTTOM, LEFT },
+    { TOP, LEFT, RIGHT, BOTTOM, BACK },
+    { TOP, FRONT, BACK, BOTTOM, RIGHT },
+    { FRONT, LEFT, BACK, RIGHT, BOTTOM }
+};
+
+// Bits of a face's count in a component's counts.
+#define COUNT_SHIFT(face) (4 * (face))
+#define FACE_COUNT(counts, face) ((int) ((counts) >> COUNT_SHIFT(face) & 0xFu))
+#define SET_FACE_COUNT(counts, face, count) \
+    (((counts) & ~(0xFu << COUNT_SHIFT(face))) | (uint32_t) (count) << COUNT_SHIFT(face))
+
+// Facelets of a face not matching its centre.
+#define SPOT_COLOUR_COUNT(face, state) ( \
+      !MATCHES_CENTRE(face, 0, 0, state) + !MATCHES_CENTRE(face, 0, 1, state) + !MATCHES_CENTRE(face, 0, 2, state) \
+    + !MATCHES_CENTRE(face, 1, 0, state) + !MATCHES_CENTRE(face, 1, 2, state) \
+    + !MATCHES_CENTRE(face, 2, 0, state) + !MATCHES_CENTRE(face, 2, 1, state) + !MATCHES_CENTRE(face, 2, 2, state))
+
+// Edges of a face not matching its centre, and corners matching neither edge beside them.
+#define MISPLACED_PIECES_COUNT(face, state) ( \
+      !MATCHES_CENTRE(face, 0, 1, state) + !MATCHES_CENTRE(face, 1, 0, state) \
+    + !MATCHES_CENTRE(face, 1, 2, state) + !MATCHES_CENTRE(face, 2, 1, state) \
+    + MISPLACED_CORNER(face, 0, 0, state) + MISPLACED_CORNER(face, 0, 2, state) \
+    + MISPLACED_CORNER(face, 2, 0, state) + MISPLACED_CORNER(face, 2, 2, state))
+
+// Corners of a top or bottom face not matching its centre, and edges matching neither centre of the axis.
+#define KOCIEMBA_AXIS_COUNT(face, other, state) ( \
+      !MATCHES_CENTRE(face, 0, 0, state) + !MATCHES_CENTRE(face, 0, 2, state) \
+    + !MATCHES_CENTRE(face, 2, 0, state) + !MATCHES_CENTRE(face, 2, 2, state) \
+    + !MATCHES_EITHER_CENTRE(face, other, 0, 1, state) + !MATCHES_EITHER_CENTRE(face, other, 1, 0, state) \
+    + !MATCHES_EITHER_CENTRE(face, other, 1, 2, state) + !MATCHES_EITHER_CENTRE(face, other, 2, 1, state))
+
+// Right and lower edges of a front or back face matching neither centre of the axis.
+#define KOCIEMBA_SLICE_COUNT(face, other, state) ( \
+    !MATCHES_EITHER_CENTRE(face, other, 1, 2, state) + !MATCHES_EITHER_CENTRE(face, other, 2, 1, state))
+
+/**
+ * Count the facelets of some faces for a component which counts facelets.
+ *
+ * @param  component Component to count for.
+ * @param  state     State to count.
+ * @param  faces     Faces to count.
+ * @param  count     Number of faces.
+ * @param  counts    Counts of every face, to replace those of faces in.
+ * @return           The counts with those of faces replaced.
+ */
+static uint32_t count_faces(HeuristicComponent component, CubeState *state, const uint8_t *faces, int count,
+                            uint32_t counts) {
+    switch (component) {
+        case SPOT_COLOUR_COMPONENT:
+            for (int i = 0; i < count; i++) {
+                int face = faces[i];
+                counts = SET_FACE_COUNT(counts, face, SPOT_COLOUR_COUNT(face, state));
+            }
+            break;
+        case MISPLACED_PIECES_COMPONENT:
+            for (int i = 0; i < count; i++) {
+                int face = faces[i];
+                counts = SET_FACE_COUNT(counts, face, MISPLACED_PIECES_COUNT(face, state));
+            }
+            break;
+        case KOCIEMBA_COMPONENT:
+            for (int i = 0; i < count; i++) {
+                int face = faces[i];
+                if (face == TOP || face == BOTTOM) {
+                    counts = SET_FACE_COUNT(counts, face, KOCIEMBA_AXIS_COUNT(face, OPPOSITE_FACES[face], state));
+                } else if (face == FRONT || face == BACK) {
+                    counts = SET_FACE_COUNT(counts, face, KOCIEMBA_SLICE_COUNT(face, OPPOSITE_FACES[face], state));
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return counts;
+}
+
+// Estimate from the count of every face, for a component which counts facelets.
+static int counts_value(HeuristicComponent component, uint32_t counts) {
+    int total = 0;
+    int max = 0;
+    int min = 8;
+    for (int face = TOP; face < FACES; face++) {
+        int count = FACE_COUNT(counts, face);
+        total += count;
+        if (max < count) max = count;
+        if (min > count) min = count;
+    }
+
+    switch (component) {
+        case SPOT_COLOUR_COMPONENT:
+            // A movement moves twelve facelets onto another face, and the rest stay on theirs.
+            return (total + 11) / 12;
+        case MISPLACED_PIECES_COMPONENT:
+            return max + min;
+        case KOCIEMBA_COMPONENT:
+            return total / 3;
+        default:
+            return 0;
+    }
+}
+
+static const ComponentEntry COMPONENTS[HEURISTIC_COMPONENTS] = {
+    [SPOT_COLOUR_COMPONENT] = {
+        .name = "spot", .admissible = true, .counts_facelets = true, .turn_invariant = true
+    },
+    [MISPLACED_PIECES_COMPONENT] = {
+        .name = "misplaced", .admissible = false, .counts_facelets = true, .turn_invariant = true
+    },
+    [KOCIEMBA_COMPONENT] = {
+        .name = "kociemba", .admissible = false, .counts_facelets = true, .turn_invariant = false
+    },
+    [PATTERN_COMPONENT] = { .name = "pattern", .admissible = true }
+};
+
+// Combine one component's estimate into the running estimate.
+static int combine(HeuristicRule rule, int h, int value) {
+    if (rule == SUM_RULE) {
+        return h + value;
+    }
+    return value > h ? value : h;
+}
+
+Heuristic patterns_heuristic(const PatternHeuristic *patterns) {
+    if (!patterns) {
+        return GREEDY_HEURISTIC;
+    }
+    return (Heuristic) { .components = 1u << PATTERN_COMPONENT, .rule = MAX_RULE, .patterns = patterns };
+}
+
+const char *component_name(HeuristicComponent component) {
+    return component < HEURISTIC_COMPONENTS ? COMPONENTS[component].name : NULL;
+}
+
+bool component_admissible(HeuristicComponent component) {
+    return component < HEURISTIC_COMPONENTS && COMPONENTS[component].admissible;
+}
+
+bool heuristic_admissible(const Heuristic *heuristic) {
+    int used = 0;
+    for (HeuristicComponent component = 0; component < HEURISTIC_COMPONENTS; component++) {
+        if (!(heuristic->components >> component & 1u)) continue;
+        if (!COMPONENTS[component].admissible) {
+            return false;
+        }
+        used++;
+    }
+
+    // A sum of two admissible estimates can count the same movements twice.
+    return heuristic->rule == MAX_RULE || used <= 1;
+}
+
+bool parse_heuristic(const char *spec, const PatternHeuristic *patterns, Heuristic *heuristic) {
+    heuristic->components = 0;
+    heuristic->rule = MAX_RULE;
+    heuristic->patterns = patterns;
+
+    if (strncmp(spec, "max:", 4) == 0) {
+        spec += 4;
+    } else if (strncmp(spec, "sum:", 4) == 0) {
+        heuristic->rule = SUM_RULE;
+        spec += 4;
+    }
+
+    while (*spec) {
+        size_t length = strcspn(spec, ",");
+        HeuristicComponent component = 0;
+        while (component < HEURISTIC_COMPONENTS
+                && !(strlen(COMPONENTS[component].name) == length
+                     && strncmp(COMPONENTS[component].name, spec, length) == 0)) {
+            component++;
+        }
+        if (component == HEURISTIC_COMPONENTS || (component == PATTERN_COMPONENT && !patterns)) {
+            return false;
+        }
+
+        heuristic->components |= 1u << component;
+        spec += length;
+        if (*spec == ',') {
+            spec++;
+        }
+    }
+
+    return heuristic->components != 0;
+}
+
+int heuristic_estimate(const Heuristic *heuristic, CubeState *state) {
+    HeuristicTally tally;
+    return heuristic_tally(heuristic, state, &tally);
+}
+
+int heuristic_tally(const Heuristic *heuristic, CubeState *state, HeuristicTally *tally) {
+    int h = 0;
+    memset(tally, 0, sizeof(HeuristicTally));
+
+    for (HeuristicComponent component = 0; component < HEURISTIC_COMPONENTS; component++) {
+        if (!(heuristic->components >> component & 1u)) continue;
+
+        const ComponentEntry *entry = &COMPONENTS[component];
+        int value = 0;
+        if (entry->counts_facelets) {
+            tally->counts[component] = count_faces(component, state, ALL_FACES, FACES, 0);
+            value = counts_value(component, tally->counts[component]);
+        } else if (heuristic->patterns) {
+            CubieState cubies;
+            if (cubies_from_state(state, &cubies)) {
+                value = pattern_heuristic_from(heuristic->patterns, &cubies, NULL, tally->distances);
+            }
+        }
+        h = combine(heuristic->rule, h, value);
+    }
+    return h;
+}
+
+int heuristic_update(const Heuristic *heuristic, const HeuristicTally *from, Movement movement,
+                     CubeState *state, HeuristicTally *tally) {
+    int h = 0;
+    *tally = *from;
+
+    for (HeuristicComponent component = 0; component < HEURISTIC_COMPONENTS; component++) {
+        if (!(heuristic->components >> component & 1u)) continue;
+
+        const ComponentEntry *entry = &COMPONENTS[component];
+        int value = 0;
+        if (entry->counts_facelets) {
+            tally->counts[component] = count_faces(component, state, TURN_FACES[movement.face],
+                                                   entry->turn_invariant ? 4 : 5, tally->counts[component]);
+            value = counts_value(component, tally->counts[component]);
+        } else if (heuristic->patterns) {
+            CubieState cubies;
+            if (cubies_from_state(state, &cubies)) {
+                value = pattern_heuristic_from(heuristic->patterns, &cubies, from->distances, tally->distances);
+            }
+        }
+        h = combine(heuristic->rule, h, value);
+    }
+    return h;
+}
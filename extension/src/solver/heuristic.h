@@ -0,0 +1,141 @@
+#ifndef __HEURISTIC_H__
+#define __HEURISTIC_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cubestate.h"
+#include "patterndb.h"
+
+/*
+ * Integer estimates of the movements needed to solve a cube, composed from a registry of components.
+ *
+ * A heuristic picks any set of components and combines them by one rule: the largest of them, or their sum.
+ * The largest of admissible estimates is admissible, so a heuristic combined that way never overestimates
+ * if none of its components do, and a search with it finds shortest solutions. Sums are quicker to
+ * steer a greedy search, but only admissible when there is at most one admissible component.
+ *
+ * Components other than the pattern databases count facelets face by face. A movement leaves the
+ * opposite face alone, and most components' counts of the turned face too, so a child's estimate is
+ * updated from its parent's counts by counting only the faces beside the turn.
+ */
+
+/**
+ * Components a heuristic can be made of.
+ */
+typedef enum {
+    SPOT_COLOUR_COMPONENT,      /**< Facelets not matching their centre, twelve per movement. Admissible. */
+    MISPLACED_PIECES_COMPONENT, /**< Most plus fewest misplaced pieces on a face. Not admissible. */
+    KOCIEMBA_COMPONENT,         /**< Facelets out of place for G1, three per movement. Not admissible. */
+    PATTERN_COMPONENT,          /**< Largest distance in the heuristic's pattern databases. Admissible. */
+    HEURISTIC_COMPONENTS        /**< Number of components. */
+} HeuristicComponent;
+
+/**
+ * How a heuristic combines its components.
+ */
+typedef enum {
+    MAX_RULE, /**< The largest component. */
+    SUM_RULE  /**< The sum of the components. */
+} HeuristicRule;
+
+/**
+ * A composed heuristic. Cheap to copy, and never owns its pattern databases.
+ */
+typedef struct {
+    uint32_t components;              /**< Bit (1u << component) set for each component used. */
+    HeuristicRule rule;               /**< How the components are combined. */
+    const PatternHeuristic *patterns; /**< Databases for PATTERN_COMPONENT, or NULL. */
+} Heuristic;
+
+/**
+ * What a heuristic counted of a state, from which a neighbour's estimate can be updated.
+ */
+typedef struct {
+    uint32_t counts[HEURISTIC_COMPONENTS]; /**< Facelets each facelet component counts, four bits a face. */
+    uint8_t distances[MAXIMUM_PATTERNS];   /**< Distance in each pattern database. */
+} HeuristicTally;
+
+// Greedy heuristic the best-first solvers and IDA* without pattern databases use.
+static const Heuristic GREEDY_HEURISTIC = { .components = 1u << MISPLACED_PIECES_COMPONENT, .rule = SUM_RULE };
+
+/**
+ * Get the heuristic the solvers use given only pattern databases.
+ *
+ * @param  patterns Pattern databases, or NULL.
+ * @return          The largest distance in patterns if given, otherwise GREEDY_HEURISTIC.
+ */
+Heuristic patterns_heuristic(const PatternHeuristic *patterns);
+
+/**
+ * Get the name of a component, as parse_heuristic reads it.
+ *
+ * @param  component Component to name.
+ * @return           Its name, or NULL if component is not one.
+ */
+const char *component_name(HeuristicComponent component);
+
+/**
+ * Check whether a component never overestimates.
+ *
+ * @param  component Component to check.
+ * @return           True if it is admissible.
+ */
+bool component_admissible(HeuristicComponent component);
+
+/**
+ * Check whether a heuristic never overestimates, so that searches with it find shortest solutions.
+ * A heuristic using PATTERN_COMPONENT without databases is judged as if it had them.
+ *
+ * @param  heuristic Heuristic to check.
+ * @return           True if it is admissible.
+ */
+bool heuristic_admissible(const Heuristic *heuristic);
+
+/**
+ * Read a heuristic from a specification like "max:pattern,spot" or "sum:misplaced,kociemba".
+ * The rule and colon may be left out, and default to max.
+ *
+ * @param[in]  spec      Specification to read.
+ * @param[in]  patterns  Databases for the pattern component, or NULL.
+ * @param[out] heuristic The heuristic read.
+ * @return               True if spec named a rule and at least one component, and patterns were given
+ *                       if the pattern component was named.
+ */
+bool parse_heuristic(const char *spec, const PatternHeuristic *patterns, Heuristic *heuristic);
+
+/**
+ * Estimate the movements needed to solve a state.
+ *
+ * @param  heuristic Heuristic to estimate with.
+ * @param  state     State to estimate.
+ * @return           The estimate, zero for a solved state.
+ */
+int heuristic_estimate(const Heuristic *heuristic, CubeState *state);
+
+/**
+ * Estimate as heuristic_estimate does, keeping what heuristic_update needs to estimate the state's children.
+ *
+ * @param[in]  heuristic Heuristic to estimate with.
+ * @param[in]  state     State to estimate.
+ * @param[out] tally     What was counted of state.
+ * @return               The estimate.
+ */
+int heuristic_tally(const Heuristic *heuristic, CubeState *state, HeuristicTally *tally);
+
+/**
+ * Estimate a state one movement from another whose tally is known.
+ * Only the faces the movement touched are counted again, and pattern distances are
+ * looked up relative to the parent's.
+ *
+ * @param[in]  heuristic Heuristic to estimate with, the same the parent was tallied with.
+ * @param[in]  from      Tally of the state the movement was applied to.
+ * @param[in]  movement  Movement that took parent to state.
+ * @param[in]  state     State to estimate.
+ * @param[out] tally     What was counted of state.
+ * @return               The estimate, as heuristic_tally would give it.
+ */
+int heuristic_update(const Heuristic *heuristic, const HeuristicTally *from, Movement movement,
+                     CubeState *state, HeuristicTally *tally);
+
+#endif  // __HEURISTIC_H__
@@ -5,131 +5,182 @@
 #include <string.h>
 #include <stdlib.h>
 
+// Number of frames entered between polls of a path's cancelled callback.
+#define CANCEL_INTERVAL 4096u
 
-
-StateStack *new_stack() {
-    StateStack *stack = (StateStack *) malloc(sizeof(StateStack));
-    stack->top_index = -1;
-    return stack;
-}
-
-bool push(StateStack *stack, CubeState *state) {
-    if (stack->top_index == MAXIMUM_MOVEMENTS - 1)
-    {
-        return false;
-    }
-    else
-    {
-        (stack->top_index)++;
-        memcpy(&(stack->contents[stack->top_index]), state, sizeof(CubeState));
-        return true;
+SearchPath *new_search_path(const Heuristic *heuristic) {
+    SearchPath *path = (SearchPath *) malloc(sizeof(SearchPath));
+    if (path) {
+        path->depth = 0;
+        path->heuristic = *heuristic;
+        path->cancelled = NULL;
+        path->context = NULL;
+        path->entered = 0u;
     }
+    return path;
 }
 
-bool pop(StateStack *stack) {
-    if (stack->top_index == -1)
-    {
-        return false;
-    }
-    else
-    {
-        (stack->top_index)--;
-        return true;
-    }
+int estimate(SearchPath *path, CubeState *state, HeuristicTally *tally) {
+    return heuristic_tally(&(path->heuristic), state, tally);
 }
 
-bool query(StateStack *stack, CubeState *dest) {
-    if (stack->top_index == -1)
-    {
-        return false;
-    }
-    else
-    {
-        memcpy(dest, &(stack->contents[stack->top_index]), sizeof(CubeState));
-        return true;
-    }
-}
+// Generate the children of the frame at the top of the path, ordered by heuristic.
+static void enter_frame(SearchPath *path) {
+    SearchFrame *frame = &(path->frames[path->depth]);
+    uint32_t allowed = CANONICAL_MOVES[path->depth ? path->moves[path->depth - 1].face : FACES];
 
-bool contains(StateStack *stack, CubeState *state) {
-    uint64_t hash = hash_cubestate(state);
+    frame->key = cubestate_key(&(frame->state));
+    frame->count = 0;
+    frame->tried = 0;
 
-    for (int i = 0; i <= stack->top_index; i++) {
-        if (hash == hash_cubestate(&(stack->contents[i]))) return true;
+    if (path->depth == MAXIMUM_MOVEMENTS) {
+        // No room for any more movements.
+        return;
     }
-    return false;
-}
 
-int comp_states(const void *s1, const void *s2) {
-    int h1 = heuristic((CubeState *)s1);
-    int h2 = heuristic((CubeState *)s2);
-    return (h1 > h2) - (h2 > h1);
-}
+    apply_all_movements_to_faces(&(frame->state), frame->children);
 
-void sort_by_heuristic(CubeState *arr, int nmemb) {
-    qsort(arr, nmemb, sizeof(CubeState), comp_states);
-}
+    // Insertion sort keeps equal heuristics in movement order.
+    for (int move = 0; move < MOVES; move++) {
+        if (!(allowed >> move & 1u)) continue;
+
+        int h = heuristic_update(&(path->heuristic), &(frame->tally), movement_from_index(move),
+                                 &(frame->children[move]), &(frame->child_tallies[move]));
+        int i = frame->count++;
 
-bool successors(CubeState *state, CubeState *dest) {
-    Movement move;
-    for (Face f = 0; f < 6; f++)
-    {
-        move.face = f;
-        for (URotation r = 0; r < 3; r++)
-        {
-            move.direction = r;
-            dest[3 * f + r] = apply_movement(state, move);
+        frame->heuristics[move] = h;
+        while (i > 0 && frame->heuristics[frame->order[i - 1]] > h) {
+            frame->order[i] = frame->order[i - 1];
+            i--;
         }
+        frame->order[i] = move;
+    }
+}
+
+// Is this state already somewhere on the path?
+static bool on_path(SearchPath *path, StateKey key) {
+    for (int i = 0; i <= path->depth; i++) {
+        if (compare_state_keys(key, path->frames[i].key) == 0) return true;
     }
-    sort_by_heuristic(dest, 18);
-    return true;
+    return false;
 }
 
-int search(StateStack *path, int g, int bound, CubeState *out, bool *found) {
+int search(SearchPath *path, int bound, bool *found) {
+    return search_below(path, 0, bound, found);
+}
+
+int search_below(SearchPath *path, int root, int bound, bool *found) {
     *found = false;
-    CubeState node;
-    query(path, &node);
-    int f = g + heuristic(&node);
+    path->depth = root;
+
+    int f = root + estimate(path, &(path->frames[root].state), &(path->frames[root].tally));
     if (f > bound) return f;
-    if (solved(&node)) {
-        *out = node;
+    if (solved(&(path->frames[root].state))) {
         *found = true;
-        return node.history_count;
+        return root;
     }
+
     int min = INT32_MAX;
-    CubeState succs[18];
-    successors(&node, succs);
-    for (int i = 0; i < 18; i++) {
-        if (!contains(path, &(succs[i]))) {
-            push(path, &(succs[i]));
-            int t = search(path, g + 1, bound, out, found);
-            if (found) return t;
-            if (t < min) min = t;
-            pop(path);
+    enter_frame(path);
+
+    while (path->depth >= root) {
+        SearchFrame *frame = &(path->frames[path->depth]);
+
+        if (frame->tried == frame->count) {
+            // Every child has been tried, so back up a movement.
+            path->depth--;
+            continue;
         }
+
+        uint8_t move = frame->order[frame->tried++];
+        f = path->depth + 1 + frame->heuristics[move];
+        if (f > bound) {
+            // Children are in heuristic order, so the rest are over the bound too.
+            if (f < min) min = f;
+            frame->tried = frame->count;
+            continue;
+        }
+
+        if (on_path(path, cubestate_key(&(frame->children[move])))) continue;
+
+        path->moves[path->depth] = movement_from_index(move);
+        path->depth++;
+        path->frames[path->depth].state = frame->children[move];
+        path->frames[path->depth].tally = frame->child_tallies[move];
+
+        if (solved(&(path->frames[path->depth].state))) {
+            *found = true;
+            return path->depth;
+        }
+
+        if (path->cancelled && ++path->entered % CANCEL_INTERVAL == 0u && path->cancelled(path->context)) {
+            return INT32_MAX;
+        }
+        enter_frame(path);
     }
+
     return min;
 }
 
-bool ida_star(CubeState *start, CubeState *dest) {
-    double bound = heuristic(start);
-    StateStack *path = new_stack();
-    push(path, start);
+bool ida_star(CubeState *start, SearchPath *path) {
+    HeuristicTally tally;
+    int bound = estimate(path, start, &tally);
+    path->frames[0].state = *start;
     while (true) {
         bool found;
-        int t = search(path, 0, bound, dest, &found);
-        if (found) {free(path); return true;}
-        if (t == INT32_MAX) {free(path); return false;}
+        int t = search(path, bound, &found);
+        if (found) return true;
+        if (t == INT32_MAX) return false;
         bound = t;
     }
 }
 
-bool ida_solve(CubeState *start, int *move_count, Movement *solution) {
-    CubeState solved_state;
-    if (ida_star(start, &solved_state)) {
-    *move_count = solved_state.history_count;
-    memcpy(solution, solved_state.history, sizeof(solved_state.history));
-    return true;
-    }
-    return false;
+/*
+ * The limits of an ida_solve, checked through its path's cancelled callback.
+ */
+typedef struct {
+    const SolveLimits *limits;
+    const SearchPath *path;
+    SolveResult result;
+} LimitCheck;
+
+static bool limit_reached(void *context) {
+    LimitCheck *check = (LimitCheck *) context;
+    return solve_limit_reached(check->limits, check->path->entered, sizeof(SearchPath), &(check->result));
 }
 
+SolveResult ida_solve(CubeState *start, const PatternHeuristic *patterns, const SolveLimits *limits,
+                      int *move_count, Movement *solution) {
+    Heuristic heuristic = patterns_heuristic(patterns);
+    return ida_solve_with(start, &heuristic, limits, move_count, solution);
+}
+
+SolveResult ida_solve_with(CubeState *start, const Heuristic *heuristic, const SolveLimits *limits,
+                           int *move_count, Movement *solution) {
+    CubieState cubies;
+    if ((heuristic->components >> PATTERN_COMPONENT & 1u) && heuristic->patterns
+            && !cubies_from_state(start, &cubies)) {
+        return SOLVE_NOT_FOUND;
+    }
+
+    SearchPath *path = new_search_path(heuristic);
+    if (!path) {
+        return SOLVE_NOT_FOUND;
+    }
+
+    LimitCheck check = { .limits = limits, .path = path, .result = SOLVE_NOT_FOUND };
+    if (limits) {
+        path->cancelled = limit_reached;
+        path->context = &check;
+    }
+
+    // The path is all the memory the search takes, so the byte limit is settled before starting.
+    if (!(limits && limit_reached(&check)) && ida_star(start, path)) {
+        *move_count = path->depth;
+        memcpy(solution, path->moves, path->depth * sizeof(Movement));
+        check.result = SOLVE_FOUND;
+    }
+
+    free(path);
+    return check.result;
+}
@@ -2,35 +2,104 @@
 #define __IDA_STAR_H__
 
 #include "cubestate.h"
+#include "heuristic.h"
+#include "patterndb.h"
 #include "solver.h"
+#include "solvelimits.h"
 #include <string.h>
 #include <stdlib.h>
 
+/*
+ * One depth of the search path: the state there, and its children in the order they are tried.
+ * Children are generated once when the frame is entered, and each child's heuristic is computed once.
+ * Only children allowed by CANONICAL_MOVES after the movement into this frame are tried.
+ * Each state's heuristic tally is kept, so its children's estimates are updated from it rather than made afresh.
+ */
 typedef struct {
-    CubeState contents[MAXIMUM_MOVEMENTS];
-    int top_index;
-} StateStack;
+    CubeState state;
+    StateKey key;
+    CubeState children[MOVES];
+    int heuristics[MOVES];
+    HeuristicTally tally;
+    HeuristicTally child_tallies[MOVES];
+    uint8_t order[MOVES];
+    uint8_t count;
+    uint8_t tried;
+} SearchFrame;
 
-StateStack *new_stack();
-
-bool push(StateStack *stack, CubeState *state);
-
-bool pop(StateStack *stack);
-
-bool query(StateStack *stack, CubeState *dest);
+/*
+ * The whole search path, with moves[i] being the movement taken from frames[i] to reach frames[i + 1].
+ * Allocated once per solve, so the search itself never allocates.
+ * With an admissible heuristic, such as one of pattern databases, the first solution found is a shortest one.
+ * Others are quicker to compute but may overestimate.
+ * If cancelled is set, it is polled every few thousand frames, and the search gives up once it returns true.
+ */
+typedef struct {
+    SearchFrame frames[MAXIMUM_MOVEMENTS + 1];
+    Movement moves[MAXIMUM_MOVEMENTS];
+    int depth;
+    Heuristic heuristic;
+    bool (*cancelled)(void *context);
+    void *context;
+    uint64_t entered;
+} SearchPath;
 
-bool contains(StateStack *stack, CubeState *state);
+SearchPath *new_search_path(const Heuristic *heuristic);
 
-int comp_states(const void *s1, const void *s2);
+/**
+ * Estimate the movements needed to solve a state, as the search does.
+ *
+ * @param[in]  path  Path whose heuristic to use.
+ * @param[in]  state State to estimate.
+ * @param[out] tally What the heuristic counted of state.
+ * @return           The estimate.
+ */
+int estimate(SearchPath *path, CubeState *state, HeuristicTally *tally);
 
-void sort_by_heuristic(CubeState *arr, int nmemb);
+int search(SearchPath *path, int bound, bool *found);
 
-bool successors(CubeState *state, CubeState *dest);
+/**
+ * Search below a fixed prefix of the path for a solution within a bound.
+ * Frames 0 to root - 1 must hold their state and key, moves 0 to root - 1 the prefix,
+ * and frames[root] the state at its end.
+ *
+ * @param[in]  path  Path holding the prefix. Holds the solution on return if one was found.
+ * @param[in]  root  Length of the prefix.
+ * @param[in]  bound Most movements a solution, including the prefix, may take as estimated.
+ * @param[out] found True if a solution was found.
+ * @return           Length of the solution if found, otherwise the smallest estimate over the bound,
+ *                   or INT32_MAX if there is none or the search was cancelled.
+ */
+int search_below(SearchPath *path, int root, int bound, bool *found);
 
-int search(StateStack *path, int g, int bound, CubeState *out, bool *found);
+bool ida_star(CubeState *start, SearchPath *path);
 
-bool ida_star(CubeState *start, CubeState *dest);
+/**
+ * Finds a solution using iterative deepening A*.
+ * Limits are checked every few thousand frames entered, which count as the nodes expanded.
+ *
+ * @param[in]  start      The starting position.
+ * @param[in]  patterns   Pattern databases to estimate with, for a shortest solution. NULL to use heuristic().
+ * @param[in]  limits     Bounds on the search, or NULL for none.
+ * @param[out] move_count The number of moves in the solution.
+ * @param[out] solution   An array of moves which transform start to a solved cube.
+ * @return                SOLVE_FOUND if a solution was found, otherwise why not.
+ */
+SolveResult ida_solve(CubeState *start, const PatternHeuristic *patterns, const SolveLimits *limits,
+                      int *move_count, Movement *solution);
 
-bool ida_solve(CubeState *start, int *move_count, Movement *solution);
+/**
+ * Finds a solution using iterative deepening A*, estimating with any heuristic.
+ * The solution is a shortest one if heuristic_admissible(heuristic) holds.
+ *
+ * @param[in]  start      The starting position.
+ * @param[in]  heuristic  Heuristic to estimate with.
+ * @param[in]  limits     Bounds on the search, or NULL for none.
+ * @param[out] move_count The number of moves in the solution.
+ * @param[out] solution   An array of moves which transform start to a solved cube.
+ * @return                SOLVE_FOUND if a solution was found, otherwise why not.
+ */
+SolveResult ida_solve_with(CubeState *start, const Heuristic *heuristic, const SolveLimits *limits,
+                           int *move_count, Movement *solution);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,375 @@
+#include "movekernel.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/*
+ * Face movement tables, indexed by movement_index, over the face data viewed as one flat array.
+ * Entry i is the square whose colour is moved into square i.
+ * Rows are padded out to KERNEL_WIDTH with zeroes so they can be loaded as whole vectors.
+ */
+static const uint8_t FACELET_MOVE_PERMUTATIONS[MOVES][KERNEL_WIDTH] = {
+    // TOP: CW, DOUBLE, CCW
+    {
+        6, 3, 0, 7, 4, 1, 8, 5, 2,
+        36, 37, 38, 12, 13, 14, 15, 16, 17,
+        9, 10, 11, 21, 22, 23, 24, 25, 26,
+        18, 19, 20, 30, 31, 32, 33, 34, 35,
+        27, 28, 29, 39, 40, 41, 42, 43, 44,
+        45, 46, 47, 48, 49, 50, 51, 52, 53
+    },
+    {
+        8, 7, 6, 5, 4, 3, 2, 1, 0,
+        27, 28, 29, 12, 13, 14, 15, 16, 17,
+        36, 37, 38, 21, 22, 23, 24, 25, 26,
+        9, 10, 11, 30, 31, 32, 33, 34, 35,
+        18, 19, 20, 39, 40, 41, 42, 43, 44,
+        45, 46, 47, 48, 49, 50, 51, 52, 53
+    },
+    {
+        2, 5, 8, 1, 4, 7, 0, 3, 6,
+        18, 19, 20, 12, 13, 14, 15, 16, 17,
+        27, 28, 29, 21, 22, 23, 24, 25, 26,
+        36, 37, 38, 30, 31, 32, 33, 34, 35,
+        9, 10, 11, 39, 40, 41, 42, 43, 44,
+        45, 46, 47, 48, 49, 50, 51, 52, 53
+    },
+    // FRONT: CW, DOUBLE, CCW
+    {
+        0, 1, 2, 3, 4, 5, 26, 23, 20,
+        15, 12, 9, 16, 13, 10, 17, 14, 11,
+        18, 19, 45, 21, 22, 46, 24, 25, 47,
+        27, 28, 29, 30, 31, 32, 33, 34, 35,
+        6, 37, 38, 7, 40, 41, 8, 43, 44,
+        42, 39, 36, 48, 49, 50, 51, 52, 53
+    },
+    {
+        0, 1, 2, 3, 4, 5, 47, 46, 45,
+        17, 16, 15, 14, 13, 12, 11, 10, 9,
+        18, 19, 42, 21, 22, 39, 24, 25, 36,
+        27, 28, 29, 30, 31, 32, 33, 34, 35,
+        26, 37, 38, 23, 40, 41, 20, 43, 44,
+        8, 7, 6, 48, 49, 50, 51, 52, 53
+    },
+    {
+        0, 1, 2, 3, 4, 5, 36, 39, 42,
+        11, 14, 17, 10, 13, 16, 9, 12, 15,
+        18, 19, 8, 21, 22, 7, 24, 25, 6,
+        27, 28, 29, 30, 31, 32, 33, 34, 35,
+        47, 37, 38, 46, 40, 41, 45, 43, 44,
+        20, 23, 26, 48, 49, 50, 51, 52, 53
+    },
+    // LEFT: CW, DOUBLE, CCW
+    {
+        35, 1, 2, 32, 4, 5, 29, 7, 8,
+        0, 10, 11, 3, 13, 14, 6, 16, 17,
+        24, 21, 18, 25, 22, 19, 26, 23, 20,
+        27, 28, 51, 30, 31, 48, 33, 34, 45,
+        36, 37, 38, 39, 40, 41, 42, 43, 44,
+        9, 46, 47, 12, 49, 50, 15, 52, 53
+    },
+    {
+        45, 1, 2, 48, 4, 5, 51, 7, 8,
+        35, 10, 11, 32, 13, 14, 29, 16, 17,
+        26, 25, 24, 23, 22, 21, 20, 19, 18,
+        27, 28, 15, 30, 31, 12, 33, 34, 9,
+        36, 37, 38, 39, 40, 41, 42, 43, 44,
+        0, 46, 47, 3, 49, 50, 6, 52, 53
+    },
+    {
+        9, 1, 2, 12, 4, 5, 15, 7, 8,
+        45, 10, 11, 48, 13, 14, 51, 16, 17,
+        20, 23, 26, 19, 22, 25, 18, 21, 24,
+        27, 28, 6, 30, 31, 3, 33, 34, 0,
+        36, 37, 38, 39, 40, 41, 42, 43, 44,
+        35, 46, 47, 32, 49, 50, 29, 52, 53
+    },
+    // BACK: CW, DOUBLE, CCW
+    {
+        38, 41, 44, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 15, 16, 17,
+        2, 19, 20, 1, 22, 23, 0, 25, 26,
+        33, 30, 27, 34, 31, 28, 35, 32, 29,
+        36, 37, 53, 39, 40, 52, 42, 43, 51,
+        45, 46, 47, 48, 49, 50, 18, 21, 24
+    },
+    {
+        53, 52, 51, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 15, 16, 17,
+        44, 19, 20, 41, 22, 23, 38, 25, 26,
+        35, 34, 33, 32, 31, 30, 29, 28, 27,
+        36, 37, 24, 39, 40, 21, 42, 43, 18,
+        45, 46, 47, 48, 49, 50, 2, 1, 0
+    },
+    {
+        24, 21, 18, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 15, 16, 17,
+        51, 19, 20, 52, 22, 23, 53, 25, 26,
+        29, 32, 35, 28, 31, 34, 27, 30, 33,
+        36, 37, 0, 39, 40, 1, 42, 43, 2,
+        45, 46, 47, 48, 49, 50, 44, 41, 38
+    },
+    // RIGHT: CW, DOUBLE, CCW
+    {
+        0, 1, 11, 3, 4, 14, 6, 7, 17,
+        9, 10, 47, 12, 13, 50, 15, 16, 53,
+        18, 19, 20, 21, 22, 23, 24, 25, 26,
+        8, 28, 29, 5, 31, 32, 2, 34, 35,
+        42, 39, 36, 43, 40, 37, 44, 41, 38,
+        45, 46, 33, 48, 49, 30, 51, 52, 27
+    },
+    {
+        0, 1, 47, 3, 4, 50, 6, 7, 53,
+        9, 10, 33, 12, 13, 30, 15, 16, 27,
+        18, 19, 20, 21, 22, 23, 24, 25, 26,
+        17, 28, 29, 14, 31, 32, 11, 34, 35,
+        44, 43, 42, 41, 40, 39, 38, 37, 36,
+        45, 46, 2, 48, 49, 5, 51, 52, 8
+    },
+    {
+        0, 1, 33, 3, 4, 30, 6, 7, 27,
+        9, 10, 2, 12, 13, 5, 15, 16, 8,
+        18, 19, 20, 21, 22, 23, 24, 25, 26,
+        53, 28, 29, 50, 31, 32, 47, 34, 35,
+        38, 41, 44, 37, 40, 43, 36, 39, 42,
+        45, 46, 11, 48, 49, 14, 51, 52, 17
+    },
+    // BOTTOM: CW, DOUBLE, CCW
+    {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 24, 25, 26,
+        18, 19, 20, 21, 22, 23, 33, 34, 35,
+        27, 28, 29, 30, 31, 32, 42, 43, 44,
+        36, 37, 38, 39, 40, 41, 15, 16, 17,
+        51, 48, 45, 52, 49, 46, 53, 50, 47
+    },
+    {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 33, 34, 35,
+        18, 19, 20, 21, 22, 23, 42, 43, 44,
+        27, 28, 29, 30, 31, 32, 15, 16, 17,
+        36, 37, 38, 39, 40, 41, 24, 25, 26,
+        53, 52, 51, 50, 49, 48, 47, 46, 45
+    },
+    {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 10, 11, 12, 13, 14, 42, 43, 44,
+        18, 19, 20, 21, 22, 23, 15, 16, 17,
+        27, 28, 29, 30, 31, 32, 24, 25, 26,
+        36, 37, 38, 39, 40, 41, 33, 34, 35,
+        47, 50, 53, 46, 49, 52, 45, 48, 51
+    }
+};
+
+typedef void (*SingleKernel)(const UColour *, const uint8_t *, UColour *);
+typedef void (*BatchKernel)(const UColour *, UColour *, size_t);
+
+static void scalar_move(const UColour *from, const uint8_t *permutation, UColour *to) {
+    for (size_t i = 0; i < FACELETS; ++i) {
+        to[i] = from[permutation[i]];
+    }
+}
+
+static void scalar_move_all(const UColour *from, UColour *to, size_t stride) {
+    for (size_t move = 0; move < MOVES; ++move) {
+        scalar_move(from, FACELET_MOVE_PERMUTATIONS[move], to + move * stride);
+    }
+}
+
+#ifdef X86_KERNELS
+
+/*
+ * The shuffle kernels split the face data into four 16 byte chunks. A byte shuffle can only
+ * pick from one chunk, so each output chunk ORs together one shuffle per source chunk.
+ *
+ * Adding 0x70 with saturation to (index - 16 * chunk) leaves indices inside the chunk with their
+ * high bit clear, and sets it for everything else, which the shuffle turns into zero.
+ */
+#define CHUNK_BIAS 0x70
+#define CHUNKS     4
+
+__attribute__((target("ssse3")))
+static void ssse3_load(const UColour *from, __m128i source[static CHUNKS]) {
+    uint8_t tail[16] = { 0 };
+    memcpy(tail, from + 48, FACELETS - 48);
+
+    source[0] = _mm_loadu_si128((const __m128i *) from);
+    source[1] = _mm_loadu_si128((const __m128i *) (from + 16));
+    source[2] = _mm_loadu_si128((const __m128i *) (from + 32));
+    source[3] = _mm_loadu_si128((const __m128i *) tail);
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_gather(const __m128i source[static CHUNKS], const uint8_t *permutation, UColour *to) {
+    const __m128i bias = _mm_set1_epi8(CHUNK_BIAS);
+    const __m128i sixteen = _mm_set1_epi8(16);
+    __m128i result[CHUNKS];
+
+    for (size_t out = 0; out < CHUNKS; ++out) {
+        __m128i indices = _mm_loadu_si128((const __m128i *) (permutation + 16 * out));
+        result[out] = _mm_setzero_si128();
+
+        for (size_t chunk = 0; chunk < CHUNKS; ++chunk) {
+            __m128i control = _mm_adds_epu8(indices, bias);
+            result[out] = _mm_or_si128(result[out], _mm_shuffle_epi8(source[chunk], control));
+            indices = _mm_sub_epi8(indices, sixteen);
+        }
+    }
+
+    uint8_t tail[16];
+    _mm_storeu_si128((__m128i *) to, result[0]);
+    _mm_storeu_si128((__m128i *) (to + 16), result[1]);
+    _mm_storeu_si128((__m128i *) (to + 32), result[2]);
+    _mm_storeu_si128((__m128i *) tail, result[3]);
+    memcpy(to + 48, tail, FACELETS - 48);
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_move(const UColour *from, const uint8_t *permutation, UColour *to) {
+    __m128i source[CHUNKS];
+    ssse3_load(from, source);
+    ssse3_gather(source, permutation, to);
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_move_all(const UColour *from, UColour *to, size_t stride) {
+    __m128i source[CHUNKS];
+    ssse3_load(from, source);
+
+    for (size_t move = 0; move < MOVES; ++move) {
+        ssse3_gather(source, FACELET_MOVE_PERMUTATIONS[move], to + move * stride);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_load(const UColour *from, __m256i source[static CHUNKS]) {
+    uint8_t tail[16] = { 0 };
+    memcpy(tail, from + 48, FACELETS - 48);
+
+    // Both 128-bit lanes hold the same chunk, as 256-bit shuffles do not cross lanes.
+    source[0] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) from));
+    source[1] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (from + 16)));
+    source[2] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (from + 32)));
+    source[3] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) tail));
+}
+
+__attribute__((target("avx2")))
+static void avx2_gather(const __m256i source[static CHUNKS], const uint8_t *permutation, UColour *to) {
+    const __m256i bias = _mm256_set1_epi8(CHUNK_BIAS);
+    const __m256i sixteen = _mm256_set1_epi8(16);
+    __m256i result[2];
+
+    for (size_t out = 0; out < 2; ++out) {
+        __m256i indices = _mm256_loadu_si256((const __m256i *) (permutation + 32 * out));
+        result[out] = _mm256_setzero_si256();
+
+        for (size_t chunk = 0; chunk < CHUNKS; ++chunk) {
+            __m256i control = _mm256_adds_epu8(indices, bias);
+            result[out] = _mm256_or_si256(result[out], _mm256_shuffle_epi8(source[chunk], control));
+            indices = _mm256_sub_epi8(indices, sixteen);
+        }
+    }
+
+    uint8_t tail[32];
+    _mm256_storeu_si256((__m256i *) to, result[0]);
+    _mm256_storeu_si256((__m256i *) tail, result[1]);
+    memcpy(to + 32, tail, FACELETS - 32);
+}
+
+__attribute__((target("avx2")))
+static void avx2_move(const UColour *from, const uint8_t *permutation, UColour *to) {
+    __m256i source[CHUNKS];
+    avx2_load(from, source);
+    avx2_gather(source, permutation, to);
+}
+
+__attribute__((target("avx2")))
+static void avx2_move_all(const UColour *from, UColour *to, size_t stride) {
+    __m256i source[CHUNKS];
+    avx2_load(from, source);
+
+    for (size_t move = 0; move < MOVES; ++move) {
+        avx2_gather(source, FACELET_MOVE_PERMUTATIONS[move], to + move * stride);
+    }
+}
+
+#endif  // X86_KERNELS
+
+static SingleKernel single_kernel = NULL;
+static BatchKernel batch_kernel = NULL;
+static MoveKernelType kernel_type = MOVE_KERNEL_SCALAR;
+// Solver threads may all make their first movement at once, so the default kernel is picked under a once.
+static pthread_once_t default_kernel_once = PTHREAD_ONCE_INIT;
+
+bool move_kernel_supported(MoveKernelType type) {
+    switch (type) {
+        case MOVE_KERNEL_SCALAR:
+            return true;
+#ifdef X86_KERNELS
+        case MOVE_KERNEL_SSSE3:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3");
+        case MOVE_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+bool select_move_kernel(MoveKernelType type) {
+    if (!move_kernel_supported(type)) {
+        return false;
+    }
+
+    switch (type) {
+#ifdef X86_KERNELS
+        case MOVE_KERNEL_AVX2:
+            single_kernel = avx2_move;
+            batch_kernel = avx2_move_all;
+            break;
+        case MOVE_KERNEL_SSSE3:
+            single_kernel = ssse3_move;
+            batch_kernel = ssse3_move_all;
+            break;
+#endif
+        default:
+            single_kernel = scalar_move;
+            batch_kernel = scalar_move_all;
+            break;
+    }
+
+    kernel_type = type;
+    return true;
+}
+
+// Pick the widest kernel the CPU supports, unless one was selected before first use.
+static void select_best_move_kernel(void) {
+    if (single_kernel) {
+        return;
+    }
+    if (!select_move_kernel(MOVE_KERNEL_AVX2) && !select_move_kernel(MOVE_KERNEL_SSSE3)) {
+        select_move_kernel(MOVE_KERNEL_SCALAR);
+    }
+}
+
+MoveKernelType active_move_kernel(void) {
+    pthread_once(&default_kernel_once, select_best_move_kernel);
+    return kernel_type;
+}
+
+void move_facelets(const UColour *from, Movement movement, UColour *to) {
+    pthread_once(&default_kernel_once, select_best_move_kernel);
+    single_kernel(from, FACELET_MOVE_PERMUTATIONS[movement_index(movement)], to);
+}
+
+void move_facelets_all(const UColour *from, UColour *to, size_t stride) {
+    pthread_once(&default_kernel_once, select_best_move_kernel);
+    batch_kernel(from, to, stride);
+}
@@ -0,0 +1,65 @@
+#ifndef __MOVEKERNEL_H__
+#define __MOVEKERNEL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cubestate.h"
+
+// Face data is moved in vectors of this many bytes; only the first FACELETS are meaningful.
+#define KERNEL_WIDTH 64
+
+/**
+ * Implementations of the facelet movement kernel.
+ */
+typedef enum {
+    MOVE_KERNEL_SCALAR = 0, /**< Plain byte gather, available everywhere. */
+    MOVE_KERNEL_SSSE3 = 1,  /**< 128-bit byte shuffles. */
+    MOVE_KERNEL_AVX2 = 2    /**< 256-bit byte shuffles. */
+} MoveKernelType;
+
+/**
+ * Move a flat array of facelets using the active kernel.
+ * The best kernel supported by the CPU is picked on first use.
+ *
+ * @param[in]  from     FACELETS colours to move from.
+ * @param[in]  movement Movement to apply.
+ * @param[out] to       FACELETS colours to write the moved facelets to. Must not overlap from.
+ */
+void move_facelets(const UColour *from, Movement movement, UColour *to);
+
+/**
+ * Apply every movement to a flat array of facelets in one call.
+ * The result of the movement with index i is written to to + i * stride.
+ *
+ * @param[in]  from   FACELETS colours to move from.
+ * @param[out] to     Where to write the first moved facelets. Must not overlap from.
+ * @param[in]  stride Distance in bytes between the outputs of consecutive movements.
+ */
+void move_facelets_all(const UColour *from, UColour *to, size_t stride);
+
+/**
+ * Check whether a kernel can run on this machine.
+ *
+ * @param  type Kernel to check.
+ * @return      True if supported.
+ */
+bool move_kernel_supported(MoveKernelType type);
+
+/**
+ * Force the movement functions to use a given kernel. Not safe while other threads are moving cubes.
+ *
+ * @param  type Kernel to use.
+ * @return      True if the kernel is supported and now in use.
+ */
+bool select_move_kernel(MoveKernelType type);
+
+/**
+ * Get the kernel currently in use, picking the best one if none has been chosen.
+ *
+ * @return The active kernel.
+ */
+MoveKernelType active_move_kernel(void);
+
+#endif  // __MOVEKERNEL_H__
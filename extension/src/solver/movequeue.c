@@ -15,28 +15,42 @@ static inline size_t parent(size_t curr) {
     return (curr - 1u) >> 1u;
 }
 
+// Push pool slots [from, to) onto the free slot stack, so the lowest is handed out first.
+static void release_slots(MovePriorityQueue *queue, size_t from, size_t to) {
+    for (size_t slot = to; slot > from; --slot) {
+        queue->free_slots[queue->free_count++] = slot - 1u;
+    }
+}
+
 MovePriorityQueue *new_move_priority_queue(size_t initial_size) {
     MovePriorityQueue *queue = (MovePriorityQueue *) malloc(sizeof(MovePriorityQueue));
     if (!queue) {
         return NULL;
     }
 
-    queue->state_queue = (MoveQueueNode *) calloc(initial_size, sizeof(MoveQueueNode));
-    if (!queue->state_queue) {
-        free(queue);
-        return NULL;
-    }
-
-    queue->pointer_tracker = new_hash_tree();
-    if (!queue->pointer_tracker) {
+    initial_size = initial_size ? initial_size : 1u;
+    queue->heap = (HeapEntry *) malloc(initial_size * sizeof(HeapEntry));
+    queue->pool = (MoveQueueNode *) malloc(initial_size * sizeof(MoveQueueNode));
+    queue->free_slots = (uint32_t *) malloc(initial_size * sizeof(uint32_t));
+    queue->positions = (size_t *) malloc(initial_size * sizeof(size_t));
+    queue->pointer_tracker = new_hash_set(initial_size);
+    if (!queue->heap || !queue->pool || !queue->free_slots || !queue->positions || !queue->pointer_tracker) {
+        free_hash_set(queue->pointer_tracker);
+        free(queue->positions);
+        free(queue->free_slots);
+        free(queue->pool);
+        free(queue->heap);
         free(queue);
         return NULL;
     }
 
     queue->size = initial_size;
     queue->count = 0u;
+    queue->free_count = 0u;
     queue->error = MQ_OK;
 
+    release_slots(queue, 0u, initial_size);
+
     return queue;
 }
 
@@ -45,103 +59,115 @@ bool free_move_priority_queue(MovePriorityQueue* queue) {
         return false;
     }
 
-    free_hash_tree(queue->pointer_tracker);
-    free(queue->state_queue);
+    free_hash_set(queue->pointer_tracker);
+    free(queue->positions);
+    free(queue->free_slots);
+    free(queue->pool);
+    free(queue->heap);
     free(queue);
 
     return true;
 }
 
-static void sift_up(MovePriorityQueue *queue, size_t start) {
-    if (start <= 0u) {
-        // We are at the heap root. Stop sifting.
-        modify_offset_in_hash_tree(queue->pointer_tracker, queue->state_queue[start].hash, start);
-        return;
-    }
-
-    // This is a min heap, so swap if current < parent.
-    size_t par = parent(start);
-    if (queue->state_queue[start].cost < queue->state_queue[par].cost) {
-        modify_offset_in_hash_tree(queue->pointer_tracker, queue->state_queue[par].hash, start);
+// Place an entry in the heap, recording where its node now sits.
+static inline void place(MovePriorityQueue *queue, size_t where, HeapEntry entry) {
+    queue->heap[where] = entry;
+    queue->positions[entry.node] = where;
+}
 
-        MoveQueueNode temp = queue->state_queue[par];
-        queue->state_queue[par] = queue->state_queue[start];
-        queue->state_queue[start] = temp;
+static void sift_up(MovePriorityQueue *queue, size_t start) {
+    HeapEntry entry = queue->heap[start];
 
-        sift_up(queue, par);
-    } else {
-        modify_offset_in_hash_tree(queue->pointer_tracker, queue->state_queue[start].hash, start);
+    // This is a min heap, so move parents down while current < parent.
+    while (start > 0u && entry.cost < queue->heap[parent(start)].cost) {
+        place(queue, start, queue->heap[parent(start)]);
+        start = parent(start);
     }
+
+    place(queue, start, entry);
 }
 
 static void sift_down(MovePriorityQueue *queue, size_t root) {
-    if (root >= queue->count) {
-        // We've exited the heap.
-        return;
-    }
-
-    size_t left = left_child(root);
-    size_t right = right_child(root);
+    HeapEntry entry = queue->heap[root];
 
-    size_t to_swap;
+    while (left_child(root) < queue->count) {
+        size_t left = left_child(root);
+        size_t right = right_child(root);
 
-    if (left >= queue->count) {
-        // Both left and right are our of heap, exit.
-        modify_offset_in_hash_tree(queue->pointer_tracker, queue->state_queue[root].hash, root);
-        return;
-    } else if (right >= queue->count) {
-        // Right is out of heap, just use left.
-        to_swap = left;
-    } else {
-        // Both children are in the heap, check as normal.
         // Swap with smaller child...
-        to_swap = (queue->state_queue[left].cost <= queue->state_queue[right].cost) ? left : right;
-    }
-
-    if (queue->state_queue[root].cost > queue->state_queue[to_swap].cost) {
-        modify_offset_in_hash_tree(queue->pointer_tracker, queue->state_queue[to_swap].hash, root);
+        size_t to_swap = (right >= queue->count || queue->heap[left].cost <= queue->heap[right].cost) ? left : right;
 
-        // Swap if larger.
-        MoveQueueNode temp = queue->state_queue[to_swap];
-        queue->state_queue[to_swap] = queue->state_queue[root];
-        queue->state_queue[root] = temp;
+        if (entry.cost <= queue->heap[to_swap].cost) {
+            break;
+        }
 
-        sift_down(queue, to_swap);
-    } else {
-        modify_offset_in_hash_tree(queue->pointer_tracker, queue->state_queue[root].hash, root);
+        place(queue, root, queue->heap[to_swap]);
+        root = to_swap;
     }
+
+    place(queue, root, entry);
 }
 
 static bool extend_move_priority_queue(MovePriorityQueue *queue) {
     size_t new_size = queue->size + (queue->size >> 1u);
     new_size = (new_size == queue->size) ? new_size + 1u : new_size;
 
-    MoveQueueNode *new_queue = (MoveQueueNode *) realloc(queue->state_queue, new_size * sizeof(MoveQueueNode));
-    if (!new_queue) {
+    if (new_size > UINT32_MAX) {
+        // Pool slots would no longer fit in a heap entry.
+        queue->error = MQ_ALLOC_ERROR;
+        return false;
+    }
+
+    HeapEntry *new_heap = (HeapEntry *) realloc(queue->heap, new_size * sizeof(HeapEntry));
+    if (!new_heap) {
         queue->error = MQ_ALLOC_ERROR;
         return false;
     }
+    queue->heap = new_heap;
 
-    queue->state_queue = new_queue;
+    MoveQueueNode *new_pool = (MoveQueueNode *) realloc(queue->pool, new_size * sizeof(MoveQueueNode));
+    if (!new_pool) {
+        queue->error = MQ_ALLOC_ERROR;
+        return false;
+    }
+    queue->pool = new_pool;
+
+    uint32_t *new_free_slots = (uint32_t *) realloc(queue->free_slots, new_size * sizeof(uint32_t));
+    if (!new_free_slots) {
+        queue->error = MQ_ALLOC_ERROR;
+        return false;
+    }
+    queue->free_slots = new_free_slots;
+
+    size_t *new_positions = (size_t *) realloc(queue->positions, new_size * sizeof(size_t));
+    if (!new_positions) {
+        queue->error = MQ_ALLOC_ERROR;
+        return false;
+    }
+    queue->positions = new_positions;
+
+    release_slots(queue, queue->size, new_size);
     queue->size = new_size;
     queue->error = MQ_OK;
 
     return true;
 }
 
-bool add_to_move_priority_queue(MovePriorityQueue *queue, const CubeState *state, const double cost) {
-    uint64_t hash = hash_cubestate(state);
-    ssize_t *idx = NULL;
+bool add_to_move_priority_queue(MovePriorityQueue *queue, const CubeState *state, PathLink link, const double cost) {
+    StateKey key = cubestate_key(state);
+    ssize_t *slot_of = NULL;
 
-    if ((idx = get_offset_from_hash_tree(queue->pointer_tracker, hash))) {
-        MoveQueueNode *found = queue->state_queue + *idx;
+    if ((slot_of = get_offset_from_hash_set(queue->pointer_tracker, key))) {
+        MoveQueueNode *found = queue->pool + *slot_of;
 
         if (cost < found->cost) {
+            size_t where = queue->positions[*slot_of];
+
             found->cost = cost;
-            memcpy(found->state.history, state->history, sizeof(state->history));
-            found->state.history_count = state->history_count;
+            found->link = link;
+            queue->heap[where].cost = cost;
 
-            sift_up(queue, found - queue->state_queue);
+            sift_up(queue, where);
         }
 
         queue->error = MQ_OK;
@@ -156,14 +182,22 @@ bool add_to_move_priority_queue(MovePriorityQueue *queue, const CubeState *state
         }
     }
 
+    uint32_t slot = queue->free_slots[--(queue->free_count)];
+    memcpy(&queue->pool[slot].state, state, sizeof(CubeState));
+    queue->pool[slot].link = link;
+    queue->pool[slot].cost = cost;
+    queue->pool[slot].key = key;
+
     size_t where = (queue->count)++;
-    memcpy(&queue->state_queue[where].state, state, sizeof(CubeState));
-    queue->state_queue[where].cost = cost;
-    queue->state_queue[where].hash = hash;
+    queue->heap[where].cost = cost;
+    queue->heap[where].node = slot;
     queue->error = MQ_OK;
 
-    if (!add_to_hash_tree(queue->pointer_tracker, hash)) {
-        fprintf(stderr, "Failed to add hash %lu to hash tree in queue.\n", hash);
+    // The key may already be tracked from an earlier stay in the queue.
+    if (!add_to_hash_set(queue->pointer_tracker, key) && !query_hash_set(queue->pointer_tracker, key)) {
+        fprintf(stderr, "Failed to add key %016lx%016lx to hash set in queue.\n", key.high, key.low);
+    } else {
+        modify_offset_in_hash_set(queue->pointer_tracker, key, slot);
     }
 
     sift_up(queue, where);
@@ -178,15 +212,16 @@ bool poll_move_priority_queue(MovePriorityQueue *queue, MoveQueueNode *out_node)
     }
 
     size_t last = --queue->count;
-    memcpy(out_node, queue->state_queue, sizeof(MoveQueueNode));
+    uint32_t slot = queue->heap[0u].node;
+    memcpy(out_node, &queue->pool[slot], sizeof(MoveQueueNode));
+    queue->free_slots[queue->free_count++] = slot;
 
-    modify_offset_in_hash_tree(queue->pointer_tracker, out_node->hash, -1);
+    modify_offset_in_hash_set(queue->pointer_tracker, out_node->key, NOT_IN_QUEUE);
 
     if (queue->count > 0u) {
-        queue->state_queue[0u] = queue->state_queue[last];
+        queue->heap[0u] = queue->heap[last];
         sift_down(queue, 0u);
     }
 
     return true;
 }
-
@@ -7,7 +7,8 @@
 #include <stdlib.h>
 
 #include "cubestate.h"
-#include "hashtree.h"
+#include "hashset.h"
+#include "movetrail.h"
 
 /**
  * Error state of a movement priority queue.
@@ -23,23 +24,37 @@ typedef enum {
  */
 typedef struct {
     CubeState state; /**< The state of the cube in this node. */
-    uint64_t hash;   /**< The hash of the cube state in this node. */
+    PathLink link;   /**< How the search reached this state. */
+    StateKey key;    /**< The exact key of the cube state in this node. */
     double cost;     /**< The cost value used for the priority sorting. */
 } MoveQueueNode;
 
+/**
+ * Entry in a priority queue's heap, referring to a node in the queue's pool.
+ */
+typedef struct {
+    double cost;   /**< The cost value used for the priority sorting. */
+    uint32_t node; /**< Index of the node in the pool. */
+} HeapEntry;
+
 // This is a min-heap priority queue.
 
 /**
  * A movememnt priority queue for the solving algorithm.
+ * Nodes stay in one pool slot while queued, and only the small heap entries move while sifting.
  */
 typedef struct {
-    size_t size;                /**< Size of the queue array. */
+    size_t size;                /**< Size of the heap, pool, free slot and position arrays. */
     size_t count;               /**< Number of nodes in this queue. */
 
-    MoveQueueNode *state_queue; /**< The internal node array. */
+    HeapEntry *heap;            /**< The heap of costs and pool indices. */
+    MoveQueueNode *pool;        /**< The pool of queued nodes. */
+    uint32_t *free_slots;       /**< Stack of unused pool slots. */
+    size_t *positions;          /**< Heap index of the node in each pool slot. */
+    size_t free_count;          /**< Number of unused pool slots. */
     MoveQueueError error;       /**< Error state of the queue. Check this after most operations. */
 
-    HashTree *pointer_tracker;  /**< Tree used to keep track of pointer locations. */
+    HashSet *pointer_tracker;  /**< Set mapping each queued state to its pool slot. */
 } MovePriorityQueue;
 
 /**
@@ -61,13 +76,15 @@ bool free_move_priority_queue(MovePriorityQueue* queue);
 
 /**
  * Add a state with its heuristic value to the queue.
+ * If the state is already queued with a higher cost, its cost and link are replaced instead.
  *
- * @param[out] queue           Queue to add to.
- * @param[in]  state           Cube state to add.
- * @param[in]  heuristic_value Cube state's movement cost.
- * @return                     If the addition is successful, returns true. Otherwise, returns false.
+ * @param[out] queue Queue to add to.
+ * @param[in]  state Cube state to add.
+ * @param[in]  link  How the search reached the state.
+ * @param[in]  cost  Cube state's movement cost.
+ * @return           If the addition is successful, returns true. Otherwise, returns false.
  */
-bool add_to_move_priority_queue(MovePriorityQueue *queue, const CubeState *state, const double cost);
+bool add_to_move_priority_queue(MovePriorityQueue *queue, const CubeState *state, PathLink link, const double cost);
 
 /**
  * Get the item with the lowest heuristic value.
@@ -0,0 +1,70 @@
+#include "movetrail.h"
+
+MoveTrail *new_move_trail(size_t initial_size) {
+    MoveTrail *trail = (MoveTrail *) malloc(sizeof(MoveTrail));
+    if (!trail) {
+        return NULL;
+    }
+
+    initial_size = initial_size ? initial_size : 1u;
+    trail->links = (PathLink *) malloc(initial_size * sizeof(PathLink));
+    if (!trail->links) {
+        free(trail);
+        return NULL;
+    }
+
+    trail->size = initial_size;
+    trail->count = 0u;
+
+    return trail;
+}
+
+bool free_move_trail(MoveTrail *trail) {
+    if (!trail) {
+        return false;
+    }
+
+    free(trail->links);
+    free(trail);
+
+    return true;
+}
+
+bool add_to_move_trail(MoveTrail *trail, PathLink link, uint32_t *index) {
+    if (trail->count >= NO_PARENT) {
+        // Indices would collide with NO_PARENT.
+        return false;
+    }
+
+    if (trail->count >= trail->size) {
+        size_t new_size = trail->size + (trail->size >> 1u) + 1u;
+
+        PathLink *new_links = (PathLink *) realloc(trail->links, new_size * sizeof(PathLink));
+        if (!new_links) {
+            return false;
+        }
+
+        trail->links = new_links;
+        trail->size = new_size;
+    }
+
+    *index = trail->count++;
+    trail->links[*index] = link;
+
+    return true;
+}
+
+int trace_moves(const MoveTrail *trail, PathLink link, Movement solution[static MAXIMUM_MOVEMENTS]) {
+    int move_count = link.depth;
+
+    // Walk back up the trail, filling in the solution from the end.
+    for (int i = move_count - 1; i >= 0; --i) {
+        solution[i] = link.move;
+
+        if (link.parent != NO_PARENT) {
+            link = trail->links[link.parent];
+        }
+    }
+
+    return move_count;
+}
@@ -0,0 +1,86 @@
+#ifndef __MOVETRAIL_H__
+#define __MOVETRAIL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "cubestate.h"
+
+// Parent of the start state, which was not reached by any movement.
+#define NO_PARENT UINT32_MAX
+
+/**
+ * How a search reached a state: the movement taken and a reference to the link of the state it was taken from.
+ */
+typedef struct {
+    uint32_t parent; /**< Trail index of the parent's link, or NO_PARENT if the parent is the start state. */
+    uint8_t depth;   /**< Number of movements from the start state. */
+    Movement move;   /**< Movement taken from the parent. Unused for the start state. */
+} PathLink;
+
+static const PathLink START_LINK = {
+    .parent = NO_PARENT,
+    .depth = 0u,
+    .move = { .face = TOP, .direction = CW }
+};
+
+/**
+ * Get the movements worth taking from the state a link reached.
+ *
+ * @param  link Link of the state.
+ * @return      Bitmask of allowed movements, indexed by movement_index. See CANONICAL_MOVES.
+ */
+static inline uint32_t moves_after(PathLink link) {
+    return CANONICAL_MOVES[link.depth ? link.move.face : FACES];
+}
+
+/**
+ * A growable array of path links for the states a search has expanded.
+ * Each expanded state's children point back at its link, so the path to any state can be rebuilt at the end.
+ */
+typedef struct {
+    size_t size;     /**< Size of the link array. */
+    size_t count;    /**< Number of links in the trail. */
+    PathLink *links; /**< The internal link array. */
+} MoveTrail;
+
+/**
+ * Create a new move trail with a given start size.
+ * The trail will expand as links are added to it.
+ *
+ * @param  initial_size Initial proposed size of the trail.
+ * @return              A pointer to the new trail if successful. NULL otherwise.
+ */
+MoveTrail *new_move_trail(size_t initial_size);
+
+/**
+ * Free a move trail.
+ *
+ * @param  trail The trail to free.
+ * @return       If trail is NULL, return false. Returns true otherwise.
+ */
+bool free_move_trail(MoveTrail *trail);
+
+/**
+ * Add the link of an expanded state to the trail.
+ *
+ * @param[out] trail Trail to add to.
+ * @param[in]  link  Link of the expanded state.
+ * @param[out] index Trail index of the new link, to use as the parent of the state's children.
+ * @return           True if the link was added. False if the trail could not grow.
+ */
+bool add_to_move_trail(MoveTrail *trail, PathLink link, uint32_t *index);
+
+/**
+ * Rebuild the movements taken to reach a state.
+ *
+ * @param[in]  trail    Trail holding the state's ancestors.
+ * @param[in]  link     Link of the state, which does not need to be in the trail.
+ * @param[out] solution Array to write the movements to, in the order they were taken.
+ * @return              The number of movements written.
+ */
+int trace_moves(const MoveTrail *trail, PathLink link, Movement solution[static MAXIMUM_MOVEMENTS]);
+
+#endif  // __MOVETRAIL_H__
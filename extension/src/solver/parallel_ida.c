@@ -0,0 +1,279 @@
+#include "parallel_ida.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * The subtree below one prefix, and the estimate at the end of the prefix.
+ */
+typedef struct {
+    uint8_t moves[PREFIX_DEPTH];
+    int estimate;
+} SearchTask;
+
+/*
+ * Indices of the tasks dealt to one worker. The owner takes from the back, thieves from the front.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t *tasks;
+    size_t front;
+    size_t back;
+} TaskDeque;
+
+/*
+ * Everything the workers share. Fields below lock are only touched while holding it.
+ */
+typedef struct {
+    CubeState start;
+    const PatternHeuristic *patterns;
+    SearchTask *tasks;
+    size_t task_count;
+    TaskDeque *deques;
+    int threads;
+    int bound;
+
+    pthread_mutex_t lock;
+    bool found;
+    int next_bound;
+    int move_count;
+    Movement solution[MAXIMUM_MOVEMENTS];
+} ParallelSearch;
+
+typedef struct {
+    ParallelSearch *search;
+    SearchPath *path;
+    int id;
+} Worker;
+
+// Add every canonical prefix below state as a task, and note the shortest solution shorter than a prefix.
+static void generate_tasks(ParallelSearch *search, SearchPath *path, CubeState *state, int depth, uint8_t *moves) {
+    uint32_t allowed = CANONICAL_MOVES[depth ? movement_from_index(moves[depth - 1]).face : FACES];
+    HeuristicTally tally;
+
+    for (uint8_t move = 0; move < MOVES; move++) {
+        if (!(allowed >> move & 1u)) continue;
+
+        CubeState child = apply_movement(state, movement_from_index(move));
+        moves[depth] = move;
+
+        if (solved(&child)) {
+            if (!search->found || depth + 1 < search->move_count) {
+                search->found = true;
+                search->move_count = depth + 1;
+                for (int i = 0; i <= depth; i++) {
+                    search->solution[i] = movement_from_index(moves[i]);
+                }
+            }
+        } else if (depth + 1 < PREFIX_DEPTH) {
+            generate_tasks(search, path, &child, depth + 1, moves);
+        } else {
+            SearchTask *task = &(search->tasks[search->task_count++]);
+            memcpy(task->moves, moves, PREFIX_DEPTH);
+            task->estimate = PREFIX_DEPTH + estimate(path, &child, &tally);
+        }
+    }
+}
+
+static bool search_cancelled(void *context) {
+    ParallelSearch *search = (ParallelSearch *) context;
+    pthread_mutex_lock(&search->lock);
+    bool found = search->found;
+    pthread_mutex_unlock(&search->lock);
+    return found;
+}
+
+// Take a task from the back of our own deque, or else steal one from the front of another's.
+static bool take_task(ParallelSearch *search, int id, size_t *task) {
+    for (int offset = 0; offset < search->threads; offset++) {
+        TaskDeque *deque = &(search->deques[(id + offset) % search->threads]);
+        bool taken = false;
+
+        pthread_mutex_lock(&deque->lock);
+        if (deque->front < deque->back) {
+            *task = offset == 0 ? deque->tasks[--deque->back] : deque->tasks[deque->front++];
+            taken = true;
+        }
+        pthread_mutex_unlock(&deque->lock);
+
+        if (taken) return true;
+    }
+    return false;
+}
+
+static void *work(void *argument) {
+    Worker *worker = (Worker *) argument;
+    ParallelSearch *search = worker->search;
+    SearchPath *path = worker->path;
+    size_t index;
+
+    while (!search_cancelled(search) && take_task(search, worker->id, &index)) {
+        SearchTask *task = &(search->tasks[index]);
+        CubeState state = search->start;
+
+        // Lay the prefix out as the first frames of the path.
+        for (int depth = 0; depth < PREFIX_DEPTH; depth++) {
+            path->frames[depth].state = state;
+            path->frames[depth].key = cubestate_key(&state);
+            path->moves[depth] = movement_from_index(task->moves[depth]);
+            state = apply_movement(&state, path->moves[depth]);
+        }
+        path->frames[PREFIX_DEPTH].state = state;
+
+        bool found;
+        int t = search_below(path, PREFIX_DEPTH, search->bound, &found);
+
+        pthread_mutex_lock(&search->lock);
+        if (found && !search->found) {
+            search->found = true;
+            search->move_count = t;
+            memcpy(search->solution, path->moves, t * sizeof(Movement));
+        } else if (!found && t < search->next_bound) {
+            search->next_bound = t;
+        }
+        pthread_mutex_unlock(&search->lock);
+    }
+
+    return NULL;
+}
+
+// Deal the tasks within the bound out to the workers, and note the smallest estimate over it.
+static void deal_tasks(ParallelSearch *search) {
+    int next = 0;
+
+    for (int id = 0; id < search->threads; id++) {
+        search->deques[id].front = 0;
+        search->deques[id].back = 0;
+    }
+
+    for (size_t index = 0; index < search->task_count; index++) {
+        if (search->tasks[index].estimate > search->bound) {
+            if (search->tasks[index].estimate < search->next_bound) {
+                search->next_bound = search->tasks[index].estimate;
+            }
+            continue;
+        }
+
+        TaskDeque *deque = &(search->deques[next]);
+        deque->tasks[deque->back++] = index;
+        next = (next + 1) % search->threads;
+    }
+}
+
+// Search every subtree to the current bound, with the calling thread as worker 0.
+static void search_bound(ParallelSearch *search, Worker *workers) {
+    pthread_t *handles = (pthread_t *) malloc(search->threads * sizeof(pthread_t));
+    bool *started = (bool *) calloc(search->threads, sizeof(bool));
+
+    deal_tasks(search);
+
+    // A worker that fails to start has its deque stolen by the others.
+    for (int id = 1; handles && started && id < search->threads; id++) {
+        started[id] = pthread_create(&handles[id], NULL, work, &workers[id]) == 0;
+    }
+    work(&workers[0]);
+    for (int id = 1; handles && started && id < search->threads; id++) {
+        if (started[id]) {
+            pthread_join(handles[id], NULL);
+        }
+    }
+
+    free(started);
+    free(handles);
+}
+
+bool parallel_ida_solve(CubeState *start, const PatternHeuristic *patterns, int threads,
+                        int *move_count, Movement *solution) {
+    CubieState cubies;
+    if (patterns && !cubies_from_state(start, &cubies)) {
+        return false;
+    }
+    if (solved(start)) {
+        *move_count = 0;
+        return true;
+    }
+
+    if (threads <= 0) {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = processors > 0 ? (int) processors : 1;
+    }
+
+    Heuristic heuristic = patterns_heuristic(patterns);
+    size_t capacity = 1;
+    for (int depth = 0; depth < PREFIX_DEPTH; depth++) {
+        capacity *= MOVES;
+    }
+
+    ParallelSearch *search = (ParallelSearch *) calloc(1, sizeof(ParallelSearch));
+    Worker *workers = (Worker *) calloc(threads, sizeof(Worker));
+    if (!search || !workers) {
+        free(workers);
+        free(search);
+        return false;
+    }
+    search->start = *start;
+    search->patterns = patterns;
+    search->threads = threads;
+    search->tasks = (SearchTask *) malloc(capacity * sizeof(SearchTask));
+    search->deques = (TaskDeque *) calloc(threads, sizeof(TaskDeque));
+    pthread_mutex_init(&search->lock, NULL);
+
+    bool ready = search->tasks && search->deques;
+    int prepared = 0;
+    for (; ready && prepared < threads; prepared++) {
+        int id = prepared;
+        workers[id].search = search;
+        workers[id].id = id;
+        workers[id].path = new_search_path(&heuristic);
+        search->deques[id].tasks = (size_t *) malloc(capacity * sizeof(size_t));
+        pthread_mutex_init(&search->deques[id].lock, NULL);
+        ready = workers[id].path && search->deques[id].tasks;
+        if (workers[id].path) {
+            workers[id].path->cancelled = search_cancelled;
+            workers[id].path->context = search;
+        }
+    }
+
+    bool found = false;
+    if (ready) {
+        uint8_t moves[PREFIX_DEPTH];
+        HeuristicTally tally;
+
+        // Estimating here, before any worker starts, also fills any tables the heuristic builds on first use.
+        search->bound = estimate(workers[0].path, start, &tally);
+        generate_tasks(search, workers[0].path, start, 0, moves);
+        if (search->bound <= PREFIX_DEPTH) {
+            // Solutions that short were all found while generating the tasks.
+            search->bound = PREFIX_DEPTH + 1;
+        }
+
+        while (!search->found) {
+            search->next_bound = INT32_MAX;
+            search_bound(search, workers);
+            if (search->found || search->next_bound == INT32_MAX) break;
+            search->bound = search->next_bound;
+        }
+
+        found = search->found;
+        if (found) {
+            *move_count = search->move_count;
+            memcpy(solution, search->solution, search->move_count * sizeof(Movement));
+        }
+    }
+
+    for (int id = 0; id < prepared; id++) {
+        free(workers[id].path);
+        free(search->deques[id].tasks);
+        pthread_mutex_destroy(&search->deques[id].lock);
+    }
+    pthread_mutex_destroy(&search->lock);
+    free(search->deques);
+    free(search->tasks);
+    free(search);
+    free(workers);
+
+    return found;
+}
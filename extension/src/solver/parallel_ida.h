@@ -0,0 +1,38 @@
+#ifndef __PARALLEL_IDA_H__
+#define __PARALLEL_IDA_H__
+
+#include <stdbool.h>
+
+#include "cubestate.h"
+#include "ida_star.h"
+#include "patterndb.h"
+
+/*
+ * IDA* spread over several threads.
+ *
+ * The tree is split at PREFIX_DEPTH: every canonical sequence of that many movements becomes a task,
+ * searching the subtree below it. For each bound, the tasks within it are dealt out to one deque per
+ * worker. Workers take tasks from the back of their own deque, and once it is empty steal from the front
+ * of the others'. When any worker finds a solution, the others are cancelled.
+ *
+ * Every subtree is searched to the same bound before the bound is raised, so with pattern databases
+ * the solution is a shortest one, as with ida_solve.
+ */
+
+// Number of movements in the prefix of each task.
+#define PREFIX_DEPTH 3
+
+/**
+ * Finds a solution using iterative deepening A* on several threads.
+ *
+ * @param[in]  start      The starting position.
+ * @param[in]  patterns   Pattern databases to estimate with, for a shortest solution. NULL to use heuristic().
+ * @param[in]  threads    Number of worker threads, or 0 for one per online processor.
+ * @param[out] move_count The number of moves in the solution.
+ * @param[out] solution   An array of moves which transform start to a solved cube.
+ * @return                True if a solution was found.
+ */
+bool parallel_ida_solve(CubeState *start, const PatternHeuristic *patterns, int threads,
+                        int *move_count, Movement *solution);
+
+#endif  // __PARALLEL_IDA_H__
@@ -0,0 +1,806 @@
+#include "patterndb.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Largest packed corner and edge, plus one.
+#define PACKED_CORNERS (PackCorner(CORNERS - 1, 2) + 1)
+#define PACKED_EDGES   (PackEdge(EDGES - 1, 1) + 1)
+
+/*
+ * Where a pattern's cubies are: the packed position and orientation of each tracked cubie,
+ * in order of cubie. Entries are packed like CubieState, but hold positions rather than cubies.
+ */
+typedef struct {
+    uint8_t corner_count;
+    uint8_t edge_count;
+    uint8_t corners[CORNERS];
+    uint8_t edges[EDGES];
+} Placement;
+
+// Where each movement sends a single packed corner or edge.
+static uint8_t corner_piece_moves[MOVES][PACKED_CORNERS];
+static uint8_t edge_piece_moves[MOVES][PACKED_EDGES];
+// Filled in by the first build_pattern_database call, from whichever thread makes it.
+static pthread_once_t piece_moves_once = PTHREAD_ONCE_INIT;
+
+static void build_piece_moves(void) {
+    for (size_t move = 0; move < MOVES; ++move) {
+        // Each cubie of a solved cube starts in its own position.
+        CubieState moved = apply_cubie_movement(&SOLVED_CUBIES, movement_from_index(move));
+
+        for (uint8_t to = 0; to < CORNERS; ++to) {
+            uint8_t from = CornerCubie(moved.corners[to]);
+            for (uint8_t twist = 0; twist < 3; ++twist) {
+                corner_piece_moves[move][PackCorner(from, twist)]
+                    = PackCorner(to, (twist + CornerTwist(moved.corners[to])) % 3);
+            }
+        }
+
+        for (uint8_t to = 0; to < EDGES; ++to) {
+            uint8_t from = EdgeCubie(moved.edges[to]);
+            for (uint8_t flip = 0; flip < 2; ++flip) {
+                edge_piece_moves[move][PackEdge(from, flip)] = PackEdge(to, flip ^ EdgeFlip(moved.edges[to]));
+            }
+        }
+    }
+}
+
+static int count_bits(unsigned int bits) {
+    int count = 0;
+    for (; bits; bits &= bits - 1u) {
+        ++count;
+    }
+    return count;
+}
+
+// Number of ways to place count pieces in n positions.
+static size_t arrangements(int n, int count) {
+    size_t result = 1u;
+    for (int i = 0; i < count; ++i) {
+        result *= n - i;
+    }
+    return result;
+}
+
+// Number of orientations of count pieces with the given number of states, out of n pieces.
+// When every piece is tracked, the last orientation follows from the others.
+static size_t orientations(int n, int count, int states) {
+    size_t result = 1u;
+    for (int i = 0; i < count && i < n - 1; ++i) {
+        result *= states;
+    }
+    return result;
+}
+
+size_t pattern_size(Pattern pattern) {
+    int corners = count_bits(pattern.corners);
+    int edges = count_bits(pattern.edges);
+
+    return arrangements(CORNERS, corners) * orientations(CORNERS, corners, 3)
+         * arrangements(EDGES, edges) * orientations(EDGES, edges, 2);
+}
+
+size_t pattern_bytes(PatternEncoding encoding, size_t size) {
+    switch (encoding) {
+        case NIBBLE_ENCODING:
+            return (size + 1u) / 2u;
+        case MOD3_ENCODING:
+            return (size + 3u) / 4u;
+        default:
+            return size;
+    }
+}
+
+// Rank distinct positions out of n, each digit counting the unused positions below it.
+static size_t rank_positions(const uint8_t *positions, int count, int n) {
+    unsigned int used = 0u;
+    size_t rank = 0u;
+
+    for (int i = 0; i < count; ++i) {
+        unsigned int below = (1u << positions[i]) - 1u;
+        rank = rank * (n - i) + positions[i] - count_bits(used & below);
+        used |= 1u << positions[i];
+    }
+
+    return rank;
+}
+
+// The inverse of rank_positions.
+static void unrank_positions(size_t rank, uint8_t *positions, int count, int n) {
+    uint8_t digits[EDGES];
+    unsigned int used = 0u;
+
+    for (int i = count - 1; i >= 0; --i) {
+        digits[i] = rank % (n - i);
+        rank /= n - i;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        uint8_t position = 0u;
+        for (int skip = digits[i]; skip > 0 || (used >> position & 1u); ++position) {
+            if (!(used >> position & 1u)) {
+                --skip;
+            }
+        }
+        positions[i] = position;
+        used |= 1u << position;
+    }
+}
+
+static size_t encode(const Placement *placement) {
+    uint8_t positions[EDGES];
+    size_t index;
+
+    for (int i = 0; i < placement->corner_count; ++i) {
+        positions[i] = CornerCubie(placement->corners[i]);
+    }
+    index = rank_positions(positions, placement->corner_count, CORNERS);
+    for (int i = 0; i < placement->corner_count && i < CORNERS - 1; ++i) {
+        index = 3u * index + CornerTwist(placement->corners[i]);
+    }
+
+    for (int i = 0; i < placement->edge_count; ++i) {
+        positions[i] = EdgeCubie(placement->edges[i]);
+    }
+    index = index * arrangements(EDGES, placement->edge_count)
+          + rank_positions(positions, placement->edge_count, EDGES);
+    for (int i = 0; i < placement->edge_count && i < EDGES - 1; ++i) {
+        index = 2u * index + EdgeFlip(placement->edges[i]);
+    }
+
+    return index;
+}
+
+// The inverse of encode, for a placement whose counts are already set.
+static void decode(size_t index, Placement *placement) {
+    uint8_t positions[EDGES];
+    int flips = 0, twists = 0;
+
+    for (int i = (placement->edge_count < EDGES ? placement->edge_count : EDGES - 1) - 1; i >= 0; --i) {
+        positions[i] = index % 2u;
+        index /= 2u;
+        flips += positions[i];
+    }
+    // A full set of edges must have an even number of flips.
+    positions[EDGES - 1] = flips % 2;
+    for (int i = 0; i < placement->edge_count; ++i) {
+        placement->edges[i] = PackEdge(0, positions[i]);
+    }
+
+    size_t edge_arrangements = arrangements(EDGES, placement->edge_count);
+    unrank_positions(index % edge_arrangements, positions, placement->edge_count, EDGES);
+    index /= edge_arrangements;
+    for (int i = 0; i < placement->edge_count; ++i) {
+        placement->edges[i] |= positions[i];
+    }
+
+    for (int i = (placement->corner_count < CORNERS ? placement->corner_count : CORNERS - 1) - 1; i >= 0; --i) {
+        positions[i] = index % 3u;
+        index /= 3u;
+        twists += positions[i];
+    }
+    // A full set of corners must have a total twist that is a multiple of three.
+    positions[CORNERS - 1] = (3 - twists % 3) % 3;
+    for (int i = 0; i < placement->corner_count; ++i) {
+        placement->corners[i] = PackCorner(0, positions[i]);
+    }
+
+    unrank_positions(index, positions, placement->corner_count, CORNERS);
+    for (int i = 0; i < placement->corner_count; ++i) {
+        placement->corners[i] |= positions[i];
+    }
+}
+
+static void place(Pattern pattern, const CubieState *cubies, Placement *out) {
+    Placement placement = {
+        .corner_count = count_bits(pattern.corners),
+        .edge_count = count_bits(pattern.edges)
+    };
+
+    for (uint8_t position = 0; position < CORNERS; ++position) {
+        uint8_t cubie = CornerCubie(cubies->corners[position]);
+        if (pattern.corners >> cubie & 1u) {
+            int slot = count_bits(pattern.corners & ((1u << cubie) - 1u));
+            placement.corners[slot] = PackCorner(position, CornerTwist(cubies->corners[position]));
+        }
+    }
+
+    for (uint8_t position = 0; position < EDGES; ++position) {
+        uint8_t cubie = EdgeCubie(cubies->edges[position]);
+        if (pattern.edges >> cubie & 1u) {
+            int slot = count_bits(pattern.edges & ((1u << cubie) - 1u));
+            placement.edges[slot] = PackEdge(position, EdgeFlip(cubies->edges[position]));
+        }
+    }
+
+    *out = placement;
+}
+
+size_t pattern_index(Pattern pattern, const CubieState *cubies) {
+    Placement placement;
+    place(pattern, cubies, &placement);
+    return encode(&placement);
+}
+
+static void move_placement(const Placement *placement, size_t move, Placement *out) {
+    out->corner_count = placement->corner_count;
+    out->edge_count = placement->edge_count;
+    for (int i = 0; i < placement->corner_count; ++i) {
+        out->corners[i] = corner_piece_moves[move][placement->corners[i]];
+    }
+    for (int i = 0; i < placement->edge_count; ++i) {
+        out->edges[i] = edge_piece_moves[move][placement->edges[i]];
+    }
+}
+
+// The stored value of an entry: a distance, its remainder mod 3, or the encoding's unreached marker.
+static inline uint8_t stored_entry(const PatternDatabase *database, size_t index) {
+    switch (database->encoding) {
+        case NIBBLE_ENCODING:
+            return database->entries[index >> 1u] >> ((index & 1u) << 2u) & 0x0fu;
+        case MOD3_ENCODING:
+            return database->entries[index >> 2u] >> ((index & 3u) << 1u) & 0x03u;
+        default:
+            return database->entries[index];
+    }
+}
+
+// The stored value of an unreached entry in each encoding.
+static const uint8_t ENCODED_UNREACHED[] = {
+    [BYTE_ENCODING] = UNREACHED_PATTERN, [NIBBLE_ENCODING] = 0x0fu, [MOD3_ENCODING] = 0x03u
+};
+
+// Find where a cube's entry is: its pattern index, or the number of its class in a reduced database.
+static size_t entry_index(const PatternDatabase *database, const CubieState *cubies) {
+    size_t index = pattern_index(database->pattern, cubies);
+    if (!database->representatives) {
+        return index;
+    }
+
+    // The class is represented by the lowest index of any conjugate.
+    for (int symmetry = 1; symmetry < database->symmetries; ++symmetry) {
+        CubieState conjugated = conjugate_cubies(cubies, symmetry);
+        size_t conjugate_index = pattern_index(database->pattern, &conjugated);
+        if (conjugate_index < index) {
+            index = conjugate_index;
+        }
+    }
+
+    size_t low = 0u, high = database->size;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2u;
+        if (database->representatives[middle] < index) {
+            low = middle + 1u;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+uint8_t pattern_distance_from(const PatternDatabase *database, const CubieState *cubies, uint8_t parent) {
+    uint8_t entry = stored_entry(database, entry_index(database, cubies));
+
+    if (entry == ENCODED_UNREACHED[database->encoding]) {
+        return UNREACHED_PATTERN;
+    } else if (database->encoding != MOD3_ENCODING) {
+        return entry;
+    }
+
+    // One movement changes the distance by at most one, and each of those has a different remainder.
+    uint8_t distance = parent + 1u;
+    while (distance % 3u != entry) {
+        --distance;
+    }
+    return distance;
+}
+
+uint8_t pattern_distance(const PatternDatabase *database, const CubieState *cubies) {
+    if (database->encoding != MOD3_ENCODING) {
+        return pattern_distance_from(database, cubies, 0u);
+    }
+
+    CubieState current = *cubies;
+    size_t index = entry_index(database, &current);
+    size_t solved = entry_index(database, &SOLVED_CUBIES);
+    uint8_t distance = 0u;
+
+    if (stored_entry(database, index) == ENCODED_UNREACHED[MOD3_ENCODING]) {
+        return UNREACHED_PATTERN;
+    }
+
+    // Count the movements of a shortest path home, each found as a neighbour one closer.
+    while (index != solved) {
+        uint8_t closer = (stored_entry(database, index) + 2u) % 3u;
+
+        for (size_t move = 0; move < MOVES; ++move) {
+            CubieState moved = apply_cubie_movement(&current, movement_from_index(move));
+            size_t next = entry_index(database, &moved);
+            if (stored_entry(database, next) == closer) {
+                current = moved;
+                index = next;
+                break;
+            }
+        }
+        ++distance;
+    }
+
+    return distance;
+}
+
+PatternDatabase *build_pattern_database(Pattern pattern) {
+    PatternDatabase *database = (PatternDatabase *) malloc(sizeof(PatternDatabase));
+    if (!database) {
+        return NULL;
+    }
+
+    database->pattern = pattern;
+    database->encoding = BYTE_ENCODING;
+    database->symmetries = 1;
+    database->representatives = NULL;
+    database->size = pattern_size(pattern);
+    database->bytes = database->size;
+    database->mapping = NULL;
+    database->mapped = 0u;
+    database->entries = (uint8_t *) malloc(database->size);
+    if (!database->entries) {
+        fprintf(stderr, "Failed to allocate %zu byte pattern database.\n", database->size);
+        free(database);
+        return NULL;
+    }
+
+    pthread_once(&piece_moves_once, build_piece_moves);
+    memset(database->entries, UNREACHED_PATTERN, database->size);
+    database->entries[pattern_index(pattern, &SOLVED_CUBIES)] = 0u;
+
+    Placement placement = {
+        .corner_count = count_bits(pattern.corners),
+        .edge_count = count_bits(pattern.edges)
+    };
+    Placement moved;
+
+    // Expand one depth at a time by scanning the table, so the search needs no queue.
+    // Once the frontier outnumbers the unreached entries, look back from those instead:
+    // every movement has an inverse, so an entry is one deeper if any movement reaches the frontier.
+    size_t found = 1u, unreached = database->size - 1u;
+    for (uint8_t depth = 0; found > 0u && unreached > 0u; ++depth) {
+        bool backwards = found > unreached;
+        uint8_t scanned = backwards ? UNREACHED_PATTERN : depth;
+        found = 0u;
+
+        for (size_t index = 0; index < database->size; ++index) {
+            if (database->entries[index] != scanned) continue;
+
+            decode(index, &placement);
+            for (size_t move = 0; move < MOVES; ++move) {
+                move_placement(&placement, move, &moved);
+
+                size_t next = encode(&moved);
+                if (backwards && database->entries[next] == depth) {
+                    database->entries[index] = depth + 1u;
+                    ++found;
+                    break;
+                } else if (!backwards && database->entries[next] == UNREACHED_PATTERN) {
+                    database->entries[next] = depth + 1u;
+                    ++found;
+                }
+            }
+        }
+
+        unreached -= found;
+    }
+
+    return database;
+}
+
+PatternDatabase *pack_pattern_database(const PatternDatabase *source, PatternEncoding encoding) {
+    if (source->encoding != BYTE_ENCODING) {
+        return NULL;
+    }
+
+    PatternDatabase *database = (PatternDatabase *) malloc(sizeof(PatternDatabase));
+    if (!database) {
+        return NULL;
+    }
+
+    *database = *source;
+    database->encoding = encoding;
+    database->bytes = pattern_bytes(encoding, source->size);
+    database->mapping = NULL;
+    database->mapped = 0u;
+    database->entries = (uint8_t *) calloc(database->bytes, 1);
+    database->representatives = NULL;
+    if (source->representatives) {
+        database->representatives = (uint32_t *) malloc(source->size * sizeof(uint32_t));
+    }
+    if (!database->entries || (source->representatives && !database->representatives)) {
+        free_pattern_database(database);
+        return NULL;
+    }
+    if (source->representatives) {
+        memcpy(database->representatives, source->representatives, source->size * sizeof(uint32_t));
+    }
+
+    for (size_t index = 0; index < source->size; ++index) {
+        uint8_t distance = source->entries[index];
+        uint8_t entry = distance;
+
+        if (distance == UNREACHED_PATTERN) {
+            entry = ENCODED_UNREACHED[encoding];
+        } else if (encoding == MOD3_ENCODING) {
+            entry = distance % 3u;
+        } else if (encoding == NIBBLE_ENCODING && distance >= ENCODED_UNREACHED[NIBBLE_ENCODING]) {
+            fprintf(stderr, "Distance %u does not fit in a nibble.\n", distance);
+            free_pattern_database(database);
+            return NULL;
+        }
+
+        switch (encoding) {
+            case NIBBLE_ENCODING:
+                database->entries[index >> 1u] |= entry << ((index & 1u) << 2u);
+                break;
+            case MOD3_ENCODING:
+                database->entries[index >> 2u] |= entry << ((index & 3u) << 1u);
+                break;
+            default:
+                database->entries[index] = entry;
+                break;
+        }
+    }
+
+    return database;
+}
+
+bool pattern_symmetric(Pattern pattern, int count) {
+    for (int symmetry = 0; symmetry < count; ++symmetry) {
+        const CubieState *cubies = symmetry_cubies(symmetry);
+
+        for (int corner = 0; corner < CORNERS; ++corner) {
+            if ((pattern.corners >> corner & 1u) && !(pattern.corners >> CornerCubie(cubies->corners[corner]) & 1u)) {
+                return false;
+            }
+        }
+        for (int edge = 0; edge < EDGES; ++edge) {
+            if ((pattern.edges >> edge & 1u) && !(pattern.edges >> EdgeCubie(cubies->edges[edge]) & 1u)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Build a cube with a pattern's cubies placed, filling the other positions with the other cubies in order.
+static void cubies_from_placement(Pattern pattern, const Placement *placement, CubieState *out) {
+    int slot = 0;
+
+    memset(out, 0xff, sizeof(CubieState));
+    for (uint8_t cubie = 0; cubie < CORNERS; ++cubie) {
+        if (pattern.corners >> cubie & 1u) {
+            uint8_t packed = placement->corners[slot++];
+            out->corners[CornerCubie(packed)] = PackCorner(cubie, CornerTwist(packed));
+        }
+    }
+    for (uint8_t cubie = 0, position = 0; cubie < CORNERS; ++cubie) {
+        if (pattern.corners >> cubie & 1u) continue;
+        while (out->corners[position] != 0xffu) ++position;
+        out->corners[position] = PackCorner(cubie, 0);
+    }
+
+    slot = 0;
+    for (uint8_t cubie = 0; cubie < EDGES; ++cubie) {
+        if (pattern.edges >> cubie & 1u) {
+            uint8_t packed = placement->edges[slot++];
+            out->edges[EdgeCubie(packed)] = PackEdge(cubie, EdgeFlip(packed));
+        }
+    }
+    for (uint8_t cubie = 0, position = 0; cubie < EDGES; ++cubie) {
+        if (pattern.edges >> cubie & 1u) continue;
+        while (out->edges[position] != 0xffu) ++position;
+        out->edges[position] = PackEdge(cubie, 0);
+    }
+}
+
+PatternDatabase *reduce_pattern_database(const PatternDatabase *source, int count) {
+    if (source->encoding != BYTE_ENCODING || source->representatives
+            || source->size > UINT32_MAX || !pattern_symmetric(source->pattern, count)) {
+        return NULL;
+    }
+
+    PatternDatabase *database = (PatternDatabase *) malloc(sizeof(PatternDatabase));
+    uint8_t *covered = (uint8_t *) calloc((source->size + 7u) / 8u, 1);
+    if (!database || !covered) {
+        free(database);
+        free(covered);
+        return NULL;
+    }
+
+    *database = *source;
+    database->symmetries = count;
+    database->size = 0u;
+    database->entries = NULL;
+    database->representatives = NULL;
+
+    size_t capacity = 0u;
+    Placement placement = {
+        .corner_count = count_bits(source->pattern.corners),
+        .edge_count = count_bits(source->pattern.edges)
+    };
+    CubieState cubies;
+
+    // The first index of each class met in order is its lowest, so its representative. Mark the rest.
+    for (size_t index = 0; index < source->size; ++index) {
+        if (covered[index >> 3u] >> (index & 7u) & 1u) continue;
+
+        if (database->size == capacity) {
+            capacity = capacity + (capacity >> 1u) + 1024u;
+            uint8_t *entries = (uint8_t *) realloc(database->entries, capacity);
+            if (entries) {
+                database->entries = entries;
+            }
+            uint32_t *representatives = (uint32_t *) realloc(database->representatives, capacity * sizeof(uint32_t));
+            if (representatives) {
+                database->representatives = representatives;
+            }
+            if (!entries || !representatives) {
+                free(covered);
+                free_pattern_database(database);
+                return NULL;
+            }
+        }
+
+        database->representatives[database->size] = index;
+        database->entries[database->size] = source->entries[index];
+        ++(database->size);
+
+        decode(index, &placement);
+        cubies_from_placement(source->pattern, &placement, &cubies);
+        for (int symmetry = 0; symmetry < count; ++symmetry) {
+            CubieState conjugated = conjugate_cubies(&cubies, symmetry);
+            size_t conjugate_index = pattern_index(source->pattern, &conjugated);
+            covered[conjugate_index >> 3u] |= 1u << (conjugate_index & 7u);
+        }
+    }
+
+    free(covered);
+    database->bytes = database->size;
+
+    // Give back the unused capacity, which can be most of it.
+    uint8_t *entries = (uint8_t *) realloc(database->entries, database->size);
+    database->entries = entries ? entries : database->entries;
+    uint32_t *representatives = (uint32_t *) realloc(database->representatives, database->size * sizeof(uint32_t));
+    database->representatives = representatives ? representatives : database->representatives;
+
+    return database;
+}
+
+// Start of a 64 bit FNV-1a hash.
+#define CHECKSUM_START UINT64_C(14695981039346656037)
+
+static uint64_t checksum(uint64_t hash, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+bool save_pattern_database(const PatternDatabase *database, const char *path) {
+    PatternFileHeader header = {
+        .version = PATTERN_FILE_VERSION,
+        .edges = database->pattern.edges,
+        .corners = database->pattern.corners,
+        .encoding = database->encoding,
+        .size = database->size,
+        .symmetries = database->symmetries
+    };
+    size_t representative_bytes = database->representatives ? database->size * sizeof(uint32_t) : 0u;
+    strncpy(header.magic, PATTERN_FILE_MAGIC, sizeof(header.magic));
+
+    // Write beside the destination and rename over it, so readers never map a partial file.
+    char *temporary = (char *) malloc(strlen(path) + sizeof(".tmp"));
+    if (!temporary) {
+        return false;
+    }
+    strcpy(temporary, path);
+    strcat(temporary, ".tmp");
+
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s for writing.\n", temporary);
+        free(temporary);
+        return false;
+    }
+
+    // The checksum covers the representatives and then the entries, in file order.
+    header.checksum = checksum(CHECKSUM_START, (const uint8_t *) database->representatives, representative_bytes);
+    header.checksum = checksum(header.checksum, database->entries, database->bytes);
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(database->representatives, 1, representative_bytes, file) == representative_bytes
+                && fwrite(database->entries, 1, database->bytes, file) == database->bytes;
+    written = (fclose(file) == 0) && written;
+    written = written && rename(temporary, path) == 0;
+
+    if (!written) {
+        fprintf(stderr, "Failed to write %s.\n", path);
+        remove(temporary);
+    }
+    free(temporary);
+
+    return written;
+}
+
+PatternDatabase *load_pattern_database(const char *path, Pattern pattern) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open %s.\n", path);
+        return NULL;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(PatternFileHeader)) {
+        fprintf(stderr, "%s is too short to be a pattern database.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = (size_t) status.st_size;
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid once the descriptor is closed.
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s.\n", path);
+        return NULL;
+    }
+
+    const PatternFileHeader *header = (const PatternFileHeader *) mapping;
+    PatternEncoding encoding = (PatternEncoding) header->encoding;
+    size_t representative_bytes = header->symmetries > 1 ? header->size * sizeof(uint32_t) : 0u;
+    uint32_t *representatives = (uint32_t *) ((uint8_t *) mapping + sizeof(PatternFileHeader));
+    uint8_t *entries = (uint8_t *) mapping + sizeof(PatternFileHeader) + representative_bytes;
+
+    const char *problem = NULL;
+    if (memcmp(header->magic, PATTERN_FILE_MAGIC, sizeof(PATTERN_FILE_MAGIC)) != 0) {
+        problem = "is not a pattern database";
+    } else if (header->version != PATTERN_FILE_VERSION) {
+        problem = "was written by a different version";
+    } else if (header->corners != pattern.corners || header->edges != pattern.edges) {
+        problem = "holds a different pattern";
+    } else if (encoding != BYTE_ENCODING && encoding != NIBBLE_ENCODING && encoding != MOD3_ENCODING) {
+        problem = "has an unknown encoding";
+    } else if (header->symmetries < 1 || header->symmetries > SYMMETRIES) {
+        problem = "has an unknown symmetry reduction";
+    } else if (header->size > pattern_size(pattern)
+            || (header->symmetries == 1 && header->size != pattern_size(pattern))
+            || representative_bytes + pattern_bytes(encoding, header->size) != length - sizeof(PatternFileHeader)) {
+        problem = "has the wrong number of entries";
+    } else if (header->checksum != checksum(CHECKSUM_START, (uint8_t *) representatives,
+                                            length - sizeof(PatternFileHeader))) {
+        problem = "fails its checksum";
+    }
+
+    PatternDatabase *database = problem ? NULL : (PatternDatabase *) malloc(sizeof(PatternDatabase));
+    if (!database) {
+        fprintf(stderr, "%s %s.\n", path, problem ? problem : "could not be loaded");
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    database->pattern = pattern;
+    database->encoding = encoding;
+    database->symmetries = header->symmetries;
+    database->representatives = representative_bytes ? representatives : NULL;
+    database->size = header->size;
+    database->bytes = length - sizeof(PatternFileHeader) - representative_bytes;
+    database->entries = entries;
+    database->mapping = mapping;
+    database->mapped = length;
+
+    return database;
+}
+
+void free_pattern_database(PatternDatabase *database) {
+    if (database) {
+        if (database->mapping) {
+            munmap(database->mapping, database->mapped);
+        } else {
+            free(database->entries);
+            free(database->representatives);
+        }
+        free(database);
+    }
+}
+
+PatternHeuristic *new_pattern_heuristic(const Pattern *patterns, size_t count, PatternEncoding encoding) {
+    if (count > MAXIMUM_PATTERNS) {
+        return NULL;
+    }
+
+    PatternHeuristic *heuristic = (PatternHeuristic *) calloc(1, sizeof(PatternHeuristic));
+    if (!heuristic) {
+        return NULL;
+    }
+
+    for (; heuristic->count < count; ++(heuristic->count)) {
+        PatternDatabase *database = build_pattern_database(patterns[heuristic->count]);
+
+        if (database && encoding != BYTE_ENCODING) {
+            PatternDatabase *packed = pack_pattern_database(database, encoding);
+            free_pattern_database(database);
+            database = packed;
+        }
+
+        heuristic->databases[heuristic->count] = database;
+        if (!database) {
+            free_pattern_heuristic(heuristic);
+            return NULL;
+        }
+    }
+
+    return heuristic;
+}
+
+// Korf's patterns, in the same order as KORF_PATTERN_FILES.
+static const Pattern KORF_PATTERN_LIST[KORF_PATTERNS] = { CORNER_PATTERN, FIRST_EDGE_PATTERN, SECOND_EDGE_PATTERN };
+
+PatternHeuristic *new_korf_heuristic(PatternEncoding encoding) {
+    return new_pattern_heuristic(KORF_PATTERN_LIST, KORF_PATTERNS, encoding);
+}
+
+PatternHeuristic *load_korf_heuristic(const char *directory) {
+    PatternHeuristic *heuristic = (PatternHeuristic *) calloc(1, sizeof(PatternHeuristic));
+    char *path = (char *) malloc(strlen(directory) + 64u);
+    if (!heuristic || !path) {
+        free(heuristic);
+        free(path);
+        return NULL;
+    }
+
+    for (; heuristic->count < KORF_PATTERNS; ++(heuristic->count)) {
+        sprintf(path, "%s/%s", directory, KORF_PATTERN_FILES[heuristic->count]);
+        heuristic->databases[heuristic->count] = load_pattern_database(path, KORF_PATTERN_LIST[heuristic->count]);
+        if (!heuristic->databases[heuristic->count]) {
+            free_pattern_heuristic(heuristic);
+            heuristic = NULL;
+            break;
+        }
+    }
+
+    free(path);
+    return heuristic;
+}
+
+void free_pattern_heuristic(PatternHeuristic *heuristic) {
+    if (heuristic) {
+        for (size_t i = 0; i < heuristic->count; ++i) {
+            free_pattern_database(heuristic->databases[i]);
+        }
+        free(heuristic);
+    }
+}
+
+int pattern_heuristic(const PatternHeuristic *heuristic, const CubieState *cubies) {
+    uint8_t distances[MAXIMUM_PATTERNS];
+    return pattern_heuristic_from(heuristic, cubies, NULL, distances);
+}
+
+int pattern_heuristic_from(const PatternHeuristic *heuristic, const CubieState *cubies,
+                           const uint8_t *parents, uint8_t *distances) {
+    int h = 0;
+    for (size_t i = 0; i < heuristic->count; ++i) {
+        distances[i] = parents
+            ? pattern_distance_from(heuristic->databases[i], cubies, parents[i])
+            : pattern_distance(heuristic->databases[i], cubies);
+        if (distances[i] > h) {
+            h = distances[i];
+        }
+    }
+    return h;
+}
@@ -0,0 +1,275 @@
+#ifndef __PATTERNDB_H__
+#define __PATTERNDB_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cubestate.h"
+#include "symmetry.h"
+
+/*
+ * Pattern databases: the exact number of movements needed to bring a subset of the cubies home,
+ * ignoring every other cubie. Since solving the whole cube solves any subset, each distance is an
+ * admissible heuristic, and so is the largest of several.
+ */
+
+// Marks a pattern database entry that is not reachable from the solved cube.
+#define UNREACHED_PATTERN 0xffu
+
+// The most pattern databases a PatternHeuristic combines.
+#define MAXIMUM_PATTERNS 4
+
+// Number of databases in Korf's heuristic.
+#define KORF_PATTERNS 3
+
+// Identifies a pattern database file, and the version of its layout.
+#define PATTERN_FILE_MAGIC   "CUBEPDB"
+#define PATTERN_FILE_VERSION 3u
+
+/**
+ * The cubies a pattern database tracks. Bit i of each mask is set if cubie i is tracked.
+ */
+typedef struct {
+    uint8_t corners;  /**< Tracked corner cubies, by Corner. */
+    uint16_t edges;   /**< Tracked edge cubies, by Edge. */
+} Pattern;
+
+// Every corner: 8! * 3^7 entries.
+static const Pattern CORNER_PATTERN = { .corners = 0xffu, .edges = 0x000u };
+// The top layer edges with the front and right bottom edges: 12! / 6! * 2^6 entries.
+static const Pattern FIRST_EDGE_PATTERN = { .corners = 0x00u, .edges = 0x03fu };
+// The remaining six edges, disjoint from FIRST_EDGE_PATTERN.
+static const Pattern SECOND_EDGE_PATTERN = { .corners = 0x00u, .edges = 0xfc0u };
+
+// File names of Korf's databases, as written by pdbbuilder.
+static const char *const KORF_PATTERN_FILES[KORF_PATTERNS] = {
+    "corners.pdb", "edges_first.pdb", "edges_second.pdb"
+};
+
+/**
+ * How a pattern database stores its distances.
+ */
+typedef enum {
+    BYTE_ENCODING = 0,   /**< One byte per entry. */
+    NIBBLE_ENCODING = 1, /**< Four bits per entry, two to a byte. Distances must be under 15. */
+    MOD3_ENCODING = 2    /**< Two bits per entry, holding the distance modulo 3. */
+} PatternEncoding;
+
+/**
+ * A distance for every placement of a pattern's cubies, indexed by pattern_index.
+ * A database reduced by symmetry instead holds one entry per class of conjugate placements.
+ * Read entries with pattern_distance, which finds the entry and undoes the encoding.
+ */
+typedef struct {
+    Pattern pattern;           /**< The tracked cubies. */
+    PatternEncoding encoding;  /**< How entries are stored. */
+    int symmetries;            /**< Number of symmetries the entries are reduced by, or 1. */
+    uint32_t *representatives; /**< Lowest pattern_index in each class, ascending, or NULL if not reduced. */
+    size_t size;               /**< Number of entries: pattern_size, or the number of classes if reduced. */
+    size_t bytes;              /**< Length of entries in bytes, see pattern_bytes. */
+    uint8_t *entries;          /**< Encoded fewest movements to solve the tracked cubies, or UNREACHED_PATTERN. */
+    void *mapping;             /**< The read-only file mapping entries lies in, or NULL if built in memory. */
+    size_t mapped;             /**< Length of the mapping. */
+} PatternDatabase;
+
+/**
+ * The start of a pattern database file, followed by the representatives of a reduced database, then the entries.
+ * Fields are in the byte order of the machine that wrote the file.
+ */
+typedef struct {
+    char magic[8];       /**< PATTERN_FILE_MAGIC, padded with NUL. */
+    uint32_t version;    /**< PATTERN_FILE_VERSION. */
+    uint16_t edges;      /**< Tracked edge cubies. */
+    uint8_t corners;     /**< Tracked corner cubies. */
+    uint8_t encoding;    /**< PatternEncoding of the entries. */
+    uint64_t size;       /**< Number of entries following the header, taking pattern_bytes bytes. */
+    uint64_t checksum;   /**< 64 bit FNV-1a hash of everything following the header. */
+    uint32_t symmetries; /**< Number of symmetries the entries are reduced by, or 1. */
+    uint32_t reserved;   /**< Zero. */
+} PatternFileHeader;
+
+/**
+ * Several pattern databases, combined by taking the largest of their distances.
+ */
+typedef struct {
+    size_t count;                                  /**< Number of databases in use. */
+    PatternDatabase *databases[MAXIMUM_PATTERNS];  /**< The databases. */
+} PatternHeuristic;
+
+/**
+ * Get the number of distinct placements of a pattern's cubies.
+ *
+ * @param  pattern Cubies to place.
+ * @return         Number of entries in a database for pattern.
+ */
+size_t pattern_size(Pattern pattern);
+
+/**
+ * Get the number of bytes an encoding takes to store some entries.
+ *
+ * @param  encoding How entries are stored.
+ * @param  size     Number of entries.
+ * @return          Number of bytes.
+ */
+size_t pattern_bytes(PatternEncoding encoding, size_t size);
+
+/**
+ * Get the index of where a cube has put a pattern's cubies.
+ *
+ * @param  pattern Cubies to look at.
+ * @param  cubies  Cube to read.
+ * @return         The index, 0 to pattern_size(pattern) - 1.
+ */
+size_t pattern_index(Pattern pattern, const CubieState *cubies);
+
+/**
+ * Build a byte encoded pattern database by a breadth first search out from the solved cube.
+ * Takes one byte per entry. The full corner pattern has 88 million entries and takes a while to build.
+ * This database must be freed later using free_pattern_database.
+ *
+ * @param  pattern Cubies to track.
+ * @return         If successful, the pointer to the new database. NULL otherwise.
+ */
+PatternDatabase *build_pattern_database(Pattern pattern);
+
+/**
+ * Copy a byte encoded database into a more compact encoding.
+ * This database must be freed later using free_pattern_database.
+ *
+ * @param  source   Byte encoded database to copy.
+ * @param  encoding Encoding of the copy.
+ * @return          If successful, the pointer to the copy. NULL if it could not be allocated,
+ *                  or if source holds distances too large for the encoding.
+ */
+PatternDatabase *pack_pattern_database(const PatternDatabase *source, PatternEncoding encoding);
+
+/**
+ * Check whether a database for a pattern can be reduced by some symmetries:
+ * whether each maps the tracked cubies onto tracked cubies.
+ *
+ * @param  pattern Cubies tracked.
+ * @param  count   Number of symmetries to check, UD_SYMMETRIES or SYMMETRIES.
+ * @return         True if every one does.
+ */
+bool pattern_symmetric(Pattern pattern, int count);
+
+/**
+ * Reduce a byte encoded database by symmetry, keeping one entry for each class of conjugate placements.
+ * Conjugates are the same distance from solved, so no distance is lost, but lookups conjugate the cube
+ * by every symmetry to find its class. The full corner pattern shrinks from 88MB to around 9MB.
+ * This database must be freed later using free_pattern_database.
+ *
+ * @param  source Byte encoded database to reduce.
+ * @param  count  Number of symmetries to reduce by, UD_SYMMETRIES or SYMMETRIES.
+ * @return        If successful, the pointer to the reduced database. NULL if it could not be allocated,
+ *                or if the symmetries do not map the pattern's cubies onto themselves.
+ */
+PatternDatabase *reduce_pattern_database(const PatternDatabase *source, int count);
+
+/**
+ * Write a database to a file, replacing any file already there only once it is complete.
+ *
+ * @param  database Database to write.
+ * @param  path     File to write to.
+ * @return          True if the whole file was written.
+ */
+bool save_pattern_database(const PatternDatabase *database, const char *path);
+
+/**
+ * Map a file written by save_pattern_database into memory, read only, after checking its header and checksum.
+ * Processes loading the same file share one copy of it in the page cache.
+ * This database must be freed later using free_pattern_database.
+ *
+ * @param  path    File to read.
+ * @param  pattern Cubies the file must track.
+ * @return         If successful, the pointer to the database. NULL if the file is missing, stale or corrupt,
+ *                 or tracks other cubies.
+ */
+PatternDatabase *load_pattern_database(const char *path, Pattern pattern);
+
+/**
+ * Free a database created by build_pattern_database, pack_pattern_database, reduce_pattern_database
+ * or load_pattern_database.
+ *
+ * @param database The database to free.
+ */
+void free_pattern_database(PatternDatabase *database);
+
+/**
+ * Get the fewest movements needed to solve the cubies a database tracks.
+ * A mod 3 encoded database recovers the distance by walking to the solved cube, taking up to MOVES lookups
+ * per movement, so prefer pattern_distance_from while searching.
+ *
+ * @param  database Database to look in.
+ * @param  cubies   Cube to read.
+ * @return          The distance.
+ */
+uint8_t pattern_distance(const PatternDatabase *database, const CubieState *cubies);
+
+/**
+ * Get the fewest movements needed to solve the cubies a database tracks, given that distance for a cube
+ * one movement away. Takes one lookup whatever the encoding.
+ *
+ * @param  database Database to look in.
+ * @param  cubies   Cube to read.
+ * @param  parent   The distance in this database of a cube one movement from cubies.
+ * @return          The distance.
+ */
+uint8_t pattern_distance_from(const PatternDatabase *database, const CubieState *cubies, uint8_t parent);
+
+/**
+ * Build a database for each pattern. The heuristic must be freed later using free_pattern_heuristic.
+ *
+ * @param  patterns Cubies to track in each database.
+ * @param  count    Number of patterns, at most MAXIMUM_PATTERNS.
+ * @param  encoding How the databases store their distances.
+ * @return          If successful, the pointer to the new heuristic. NULL otherwise.
+ */
+PatternHeuristic *new_pattern_heuristic(const Pattern *patterns, size_t count, PatternEncoding encoding);
+
+/**
+ * Build Korf's heuristic: the corners, and two disjoint sets of six edges.
+ *
+ * @param  encoding How the databases store their distances.
+ * @return          If successful, the pointer to the new heuristic. NULL otherwise.
+ */
+PatternHeuristic *new_korf_heuristic(PatternEncoding encoding);
+
+/**
+ * Load Korf's heuristic from the files pdbbuilder writes.
+ *
+ * @param  directory Directory holding KORF_PATTERN_FILES.
+ * @return           If successful, the pointer to the new heuristic. NULL otherwise.
+ */
+PatternHeuristic *load_korf_heuristic(const char *directory);
+
+/**
+ * Free a heuristic created by new_pattern_heuristic or load_korf_heuristic, and its databases.
+ *
+ * @param heuristic The heuristic to free.
+ */
+void free_pattern_heuristic(PatternHeuristic *heuristic);
+
+/**
+ * Get a lower bound on the movements needed to solve a cube: the largest distance in any database.
+ *
+ * @param  heuristic Databases to look in.
+ * @param  cubies    Cube to read.
+ * @return           The bound.
+ */
+int pattern_heuristic(const PatternHeuristic *heuristic, const CubieState *cubies);
+
+/**
+ * Get the same bound as pattern_heuristic, reusing the distances of a cube one movement away.
+ *
+ * @param[in]  heuristic Databases to look in.
+ * @param[in]  cubies    Cube to read.
+ * @param[in]  parents   Distance in each database of a cube one movement from cubies, or NULL if unknown.
+ * @param[out] distances Distance in each database of cubies.
+ * @return               The bound.
+ */
+int pattern_heuristic_from(const PatternHeuristic *heuristic, const CubieState *cubies,
+                           const uint8_t *parents, uint8_t *distances);
+
+#endif  // __PATTERNDB_H__
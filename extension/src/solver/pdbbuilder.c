@@ -0,0 +1,147 @@
+#include "patterndb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Builds the pattern databases for Korf's heuristic and writes them to a directory,
+ * so solvers can map them in instead of building them on every run.
+ * With -s, the corner database is reduced by symmetry to a 48th of its size.
+ * With -r, instead reports the size and lookup speed of each encoding.
+ */
+
+// Number of random cubes each encoding is timed on in the report.
+#define REPORT_LOOKUPS 1000000
+
+static const char *const ENCODING_NAMES[] = {
+    [BYTE_ENCODING] = "byte", [NIBBLE_ENCODING] = "nibble", [MOD3_ENCODING] = "mod3"
+};
+
+static double seconds_since(clock_t start) {
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Time lookups of the same random walk in each encoding of one of Korf's edge databases.
+static int report(void) {
+    printf("Building %zu entry edge database...\n", pattern_size(FIRST_EDGE_PATTERN));
+    fflush(stdout);
+
+    clock_t start = clock();
+    PatternDatabase *databases[3] = { build_pattern_database(FIRST_EDGE_PATTERN) };
+    if (!databases[BYTE_ENCODING]) {
+        return EXIT_FAILURE;
+    }
+    printf("Built in %.2fs.\n\n", seconds_since(start));
+
+    CubieState *walk = (CubieState *) malloc(REPORT_LOOKUPS * sizeof(CubieState));
+    if (!walk) {
+        return EXIT_FAILURE;
+    }
+    walk[0] = apply_cubie_movement(&SOLVED_CUBIES, movement_from_index(rand() % MOVES));
+    for (size_t i = 1; i < REPORT_LOOKUPS; ++i) {
+        walk[i] = apply_cubie_movement(&walk[i - 1], movement_from_index(rand() % MOVES));
+    }
+
+    printf("%-8s %12s %10s %14s %14s\n", "encoding", "bytes", "pack (s)", "lookup (ns)", "from parent (ns)");
+    for (int encoding = BYTE_ENCODING; encoding <= MOD3_ENCODING; ++encoding) {
+        start = clock();
+        if (encoding != BYTE_ENCODING) {
+            databases[encoding] = pack_pattern_database(databases[BYTE_ENCODING], (PatternEncoding) encoding);
+            if (!databases[encoding]) {
+                return EXIT_FAILURE;
+            }
+        }
+        double pack = seconds_since(start);
+
+        // Keep a running total so the lookups cannot be skipped.
+        unsigned long total = 0u;
+        start = clock();
+        for (size_t i = 0; i < REPORT_LOOKUPS; ++i) {
+            total += pattern_distance(databases[encoding], &walk[i]);
+        }
+        double lookup = seconds_since(start) * 1e9 / REPORT_LOOKUPS;
+
+        uint8_t distance = pattern_distance(databases[encoding], &SOLVED_CUBIES);
+        start = clock();
+        for (size_t i = 0; i < REPORT_LOOKUPS; ++i) {
+            distance = pattern_distance_from(databases[encoding], &walk[i], distance);
+            total -= distance;
+        }
+        double from_parent = seconds_since(start) * 1e9 / REPORT_LOOKUPS;
+
+        printf("%-8s %12zu %10.2f %14.1f %14.1f%s\n", ENCODING_NAMES[encoding], databases[encoding]->bytes,
+               pack, lookup, from_parent, total ? " (mismatch)" : "");
+    }
+
+    for (int encoding = BYTE_ENCODING; encoding <= MOD3_ENCODING; ++encoding) {
+        free_pattern_database(databases[encoding]);
+    }
+    free(walk);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    PatternEncoding encoding = NIBBLE_ENCODING;
+    const char *directory = ".";
+    bool reduce = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-r") == 0) {
+            return report();
+        } else if (strcmp(argv[i], "-s") == 0) {
+            reduce = true;
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            ++i;
+            for (encoding = BYTE_ENCODING; encoding <= MOD3_ENCODING; ++encoding) {
+                if (strcmp(argv[i], ENCODING_NAMES[encoding]) == 0) break;
+            }
+            if (encoding > MOD3_ENCODING) {
+                printf("Unknown encoding %s.\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (i == argc - 1 && argv[i][0] != '-') {
+            directory = argv[i];
+        } else {
+            printf("Usage: pdbbuilder [-e byte|nibble|mod3] [-s] [directory]\n");
+            printf("       pdbbuilder -r\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    const Pattern patterns[KORF_PATTERNS] = { CORNER_PATTERN, FIRST_EDGE_PATTERN, SECOND_EDGE_PATTERN };
+    char path[FILENAME_MAX];
+
+    for (size_t i = 0; i < KORF_PATTERNS; ++i) {
+        snprintf(path, sizeof(path), "%s/%s", directory, KORF_PATTERN_FILES[i]);
+        printf("Building %s (%zu entries, %s encoded)...\n", path, pattern_size(patterns[i]),
+               ENCODING_NAMES[encoding]);
+        fflush(stdout);
+
+        PatternDatabase *database = build_pattern_database(patterns[i]);
+        // Only the corners are mapped onto themselves by every symmetry.
+        if (database && reduce && pattern_symmetric(patterns[i], SYMMETRIES)) {
+            PatternDatabase *reduced = reduce_pattern_database(database, SYMMETRIES);
+            free_pattern_database(database);
+            database = reduced;
+        }
+        if (database && encoding != BYTE_ENCODING) {
+            PatternDatabase *packed = pack_pattern_database(database, encoding);
+            free_pattern_database(database);
+            database = packed;
+        }
+        if (!database) {
+            return EXIT_FAILURE;
+        }
+
+        bool saved = save_pattern_database(database, path);
+        free_pattern_database(database);
+        if (!saved) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,33 @@
+#include "solvelimits.h"
+
+bool solve_limit_reached(const SolveLimits *limits, uint64_t nodes, size_t bytes, SolveResult *result) {
+    if (!limits) {
+        return false;
+    }
+
+    if ((limits->max_nodes && nodes >= limits->max_nodes) || (limits->max_bytes && bytes > limits->max_bytes)) {
+        *result = SOLVE_LIMIT_HIT;
+        return true;
+    }
+
+    if (nodes % LIMIT_CHECK_INTERVAL != 0u) {
+        return false;
+    }
+
+    if (limits->cancel && __atomic_load_n(limits->cancel, __ATOMIC_RELAXED)) {
+        *result = SOLVE_CANCELLED;
+        return true;
+    }
+
+    if (limits->deadline) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > limits->deadline->tv_sec
+                || (now.tv_sec == limits->deadline->tv_sec && now.tv_nsec >= limits->deadline->tv_nsec)) {
+            *result = SOLVE_LIMIT_HIT;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,44 @@
+#ifndef __SOLVELIMITS_H__
+#define __SOLVELIMITS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Number of nodes between looks at the clock and the cancel flag.
+#define LIMIT_CHECK_INTERVAL 256u
+
+/**
+ * Outcome of a solve.
+ */
+typedef enum {
+    SOLVE_FOUND,     /**< A solution was found. */
+    SOLVE_NOT_FOUND, /**< The search ended without a solution, or could not allocate memory. */
+    SOLVE_LIMIT_HIT, /**< The search stopped at its node, memory or time limit. */
+    SOLVE_CANCELLED  /**< The search stopped because its cancel flag was set. */
+} SolveResult;
+
+/**
+ * Bounds on the work a solve may do. Any field left zero or NULL is unlimited.
+ * A solve that reaches a limit frees what it allocated and returns at once.
+ */
+typedef struct {
+    uint64_t max_nodes;              /**< Most states to expand. */
+    size_t max_bytes;                /**< Most bytes the search's queue, visited set and trail may hold. */
+    const struct timespec *deadline; /**< When to give up, on CLOCK_MONOTONIC. */
+    const int *cancel;               /**< Flag another thread may set to nonzero to stop the solve. Read atomically. */
+} SolveLimits;
+
+/**
+ * Check a search against its limits. The clock and cancel flag are only read every LIMIT_CHECK_INTERVAL nodes.
+ *
+ * @param[in]  limits Limits to check, or NULL for none.
+ * @param[in]  nodes  Number of states expanded so far.
+ * @param[in]  bytes  Number of bytes the search holds.
+ * @param[out] result SOLVE_LIMIT_HIT or SOLVE_CANCELLED, if a limit was reached.
+ * @return            True if the search must stop.
+ */
+bool solve_limit_reached(const SolveLimits *limits, uint64_t nodes, size_t bytes, SolveResult *result);
+
+#endif  // __SOLVELIMITS_H__
@@ -1,40 +1,58 @@
 #include "cubestate.h"
+#include "heuristic.h"
 #include "movequeue.h"
 #include "solver.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-bool solve(CubeState *start, int *move_count, Movement *solution) {
-    MovePriorityQueue *queue = new_move_priority_queue(100);
+// Limits on g1_solve when it is given none: the memory of about 4000000 queued states, the old cap on its queue.
+static const SolveLimits G1_DEFAULT_LIMITS = { .max_bytes = 4000000u * sizeof(MoveQueueNode) };
+
+// Bytes held by a best-first search: its queued nodes, and the slots of its visited set and trail.
+static size_t search_bytes(size_t queued, const HashSet *visited, const MoveTrail *trail) {
+    return queued * sizeof(MoveQueueNode) + visited->size * sizeof(SetEntry) + trail->size * sizeof(PathLink);
+}
+
+/*
+ * Record that the state reached by link is being expanded, giving the parent index for its children.
+ * The start state needs no link of its own.
+ */
+static bool record_expansion(MoveTrail *trail, PathLink link, uint32_t *parent) {
+    if (link.depth == 0) {
+        *parent = NO_PARENT;
+        return true;
+    }
+
+    return add_to_move_trail(trail, link, parent);
+}
+
+SolveResult solve(CubeState *start, const SolveLimits *limits, int *move_count, Movement *solution) {
+    MoveBucketQueue *queue = new_move_bucket_queue(2 * MAXIMUM_MOVEMENTS);
     MoveQueueNode query_result;
-    add_to_move_priority_queue(queue, start, estimate_cost(start));
-    HashTree* visitedHashes = new_hash_tree();
+    add_to_move_bucket_queue(queue, start, START_LINK, estimate_cost(start, 0));
+    HashSet* visitedHashes = new_hash_set(100);
+    MoveTrail *trail = new_move_trail(100);
+    SolveResult result = SOLVE_NOT_FOUND;
+    uint64_t expanded = 0;
+    uint32_t parent;
     int count = 0;
     int count2 = 0;
 
     while(queue->count > 0) {
 
         // Get next state from the queue
-        if (!poll_move_priority_queue(queue, &query_result)) {
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
-
-            return false;
+        if (!poll_move_bucket_queue(queue, &query_result)) {
+            break;
         }
         count2++;
 
 #ifndef MAIN_IS_CALLING
-        if (queue->count > 4000000 && 0) {
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
-            return false;
-        }
-
-        if (query_result.state.history_count > count && 0) {
+        if (query_result.link.depth > count && 0) {
             printf("%d count\t", ++count);
             printf("%d count\t", count2);
             printf("%ld in queue\n", queue->count);
@@ -43,166 +61,214 @@ bool solve(CubeState *start, int *move_count, Movement *solution) {
 #endif
 
         if (!visit(&(query_result.state), visitedHashes)) {
-            fprintf(stderr, "visited before, shouldn't have been in queue!\n");
+            // A copy of a state already expanded through a path at least as cheap.
             continue;
         }
 
         if (solved(&(query_result.state))) {
-            *move_count = query_result.state.history_count;
-            memcpy(solution, query_result.state.history, sizeof(query_result.state.history));
-
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
+            *move_count = trace_moves(trail, query_result.link, solution);
+            result = SOLVE_FOUND;
+            break;
+        }
 
-            return true;
+        if (solve_limit_reached(limits, expanded++, search_bytes(queue->count, visitedHashes, trail), &result)
+                || !record_expansion(trail, query_result.link, &parent)) {
+            break;
         }
 
-        expand_all_moves(&(query_result.state), queue, visitedHashes);
+        // A child dropped for want of memory could be the way to the goal, so the search stops instead.
+        if (!expand_all_moves(&(query_result.state), query_result.link, parent, queue, visitedHashes)) {
+            break;
+        }
     }
 
-    free_hash_tree(visitedHashes);
-    free_move_priority_queue(queue);
+    free_move_trail(trail);
+    free_hash_set(visitedHashes);
+    free_move_bucket_queue(queue);
 
-    return false;
+    return result;
 }
 
-static double spot_colour_heuristic(CubeState *state) {
-    double count = 36;
-    for (int face = TOP; face < FACES; face++) {
-        for (int row = 0; row < SIDE_LENGTH; row++) {
-            for (int col = 0; col < SIDE_LENGTH; col++) {
-                if (MATCHES_CENTRE(face, row, col, state)) {
-                    count--;
-                }
-            }
+/*
+ * What partial_expansion_solve keeps of a state it has expanded. The state's offset in the expanded set
+ * is the index of its entry.
+ */
+typedef struct {
+    uint32_t parent;   /**< Trail index its children link to, or NO_PARENT for the start state. */
+    int depth;         /**< Number of movements it was reached in. */
+    unsigned int cost; /**< Cost it is queued again at, or EXPANDED_FULLY. */
+} ExpandedEntry;
+
+// Cost noted for a state with no children left to queue.
+#define EXPANDED_FULLY UINT_MAX
+
+/*
+ * Add an entry for a newly expanded state, doubling the array if it is full.
+ * Returns its index, or -1 if the array could not grow.
+ */
+static ssize_t add_expanded_entry(ExpandedEntry **entries, size_t *count, size_t *size) {
+    if (*count == *size) {
+        ExpandedEntry *grown = (ExpandedEntry *) realloc(*entries, 2 * *size * sizeof(ExpandedEntry));
+        if (!grown) {
+            return -1;
         }
+        *entries = grown;
+        *size *= 2;
     }
-    return count / 12;
+    return (ssize_t) (*count)++;
 }
 
-// static double edge_piece_heuristic(CubeState *state) {
-//     double count = 12;
-//     if (MATCHES_CENTRE(TOP, 0, 1, state) && MATCHES_CENTRE(BACK, 0, 1, state)) count--;
-//     if (MATCHES_CENTRE(TOP, 1, 0, state) && MATCHES_CENTRE(LEFT, 0, 1, state)) count--;
-//     if (MATCHES_CENTRE(TOP, 1, 2, state) && MATCHES_CENTRE(RIGHT, 0, 1, state)) count--;
-//     if (MATCHES_CENTRE(TOP, 2, 1, state) && MATCHES_CENTRE(FRONT, 0, 1, state)) count--;
-
-//     if (MATCHES_CENTRE(LEFT, 1, 0, state) && MATCHES_CENTRE(BACK, 1, 2, state)) count--;
-//     if (MATCHES_CENTRE(BACK, 1, 0, state) && MATCHES_CENTRE(RIGHT, 1, 2, state)) count--;
-//     if (MATCHES_CENTRE(RIGHT, 1, 0, state) && MATCHES_CENTRE(FRONT, 1, 2, state)) count--;
-//     if (MATCHES_CENTRE(FRONT, 1, 0, state) && MATCHES_CENTRE(LEFT, 1, 2, state)) count--;
-
-//     if (MATCHES_CENTRE(BOTTOM, 0, 1, state) && MATCHES_CENTRE(FRONT, 2, 1, state)) count--;
-//     if (MATCHES_CENTRE(BOTTOM, 1, 0, state) && MATCHES_CENTRE(LEFT, 2, 1, state)) count--;
-//     if (MATCHES_CENTRE(BOTTOM, 1, 2, state) && MATCHES_CENTRE(RIGHT, 2, 1, state)) count--;
-//     if (MATCHES_CENTRE(BOTTOM, 2, 1, state) && MATCHES_CENTRE(BACK, 2, 1, state)) count--;
-
-//     return count / 4;
-// }
-
-// static double corner_piece_heuristic(CubeState *state) {
-//     double count = 4;
-//     if (MATCHES_CENTRE(TOP, 0, 0, state) && MATCHES_CENTRE(BACK, 0, 2, state) && MATCHES_CENTRE(LEFT, 0, 0, state)) count--;
-//     if (MATCHES_CENTRE(TOP, 0, 2, state) && MATCHES_CENTRE(RIGHT, 0, 2, state) && MATCHES_CENTRE(BACK, 0, 0, state)) count--;
-//     if (MATCHES_CENTRE(TOP, 2, 2, state) && MATCHES_CENTRE(FRONT, 0, 2, state) && MATCHES_CENTRE(RIGHT, 0, 0, state)) count--;
-//     if (MATCHES_CENTRE(TOP, 2, 0, state) && MATCHES_CENTRE(LEFT, 0, 2, state) && MATCHES_CENTRE(FRONT, 0, 0, state)) count--;
-
-//     if (MATCHES_CENTRE(BOTTOM, 0, 0, state) && MATCHES_CENTRE(LEFT, 2, 2, state) && MATCHES_CENTRE(FRONT, 2, 0, state)) count--;
-//     if (MATCHES_CENTRE(BOTTOM, 0, 2, state) && MATCHES_CENTRE(FRONT, 2, 2, state) && MATCHES_CENTRE(RIGHT, 2, 0, state)) count--;
-//     if (MATCHES_CENTRE(BOTTOM, 2, 2, state) && MATCHES_CENTRE(RIGHT, 2, 2, state) && MATCHES_CENTRE(BACK, 2, 0, state)) count--;
-//     if (MATCHES_CENTRE(BOTTOM, 2, 0, state) && MATCHES_CENTRE(BACK, 2, 2, state) && MATCHES_CENTRE(LEFT, 2, 0, state)) count--;
-
-//     return count / 4;
-// }
-
-static double kociemba_heuristic(CubeState *state) {
-    double count = 20;
-    if (MATCHES_CENTRE(TOP, 0, 0, state)) count--;
-    if (MATCHES_CENTRE(TOP, 0, 2, state)) count--;
-    if (MATCHES_CENTRE(TOP, 2, 0, state)) count--;
-    if (MATCHES_CENTRE(TOP, 2, 2, state)) count--;
-    if (MATCHES_CENTRE(BOTTOM, 0, 0, state)) count--;
-    if (MATCHES_CENTRE(BOTTOM, 0, 2, state)) count--;
-    if (MATCHES_CENTRE(BOTTOM, 2, 0, state)) count--;
-    if (MATCHES_CENTRE(BOTTOM, 2, 2, state)) count--;
-
-    if (MATCHES_EITHER_CENTRE(TOP, BOTTOM, 0, 1, state)) count--;
-    if (MATCHES_EITHER_CENTRE(TOP, BOTTOM, 1, 0, state)) count--;
-    if (MATCHES_EITHER_CENTRE(TOP, BOTTOM, 1, 2, state)) count--;
-    if (MATCHES_EITHER_CENTRE(TOP, BOTTOM, 2, 1, state)) count--;
-    if (MATCHES_EITHER_CENTRE(BOTTOM, TOP, 0, 1, state)) count--;
-    if (MATCHES_EITHER_CENTRE(BOTTOM, TOP, 1, 0, state)) count--;
-    if (MATCHES_EITHER_CENTRE(BOTTOM, TOP, 1, 2, state)) count--;
-    if (MATCHES_EITHER_CENTRE(BOTTOM, TOP, 2, 1, state)) count--;
-
-    if (MATCHES_EITHER_CENTRE(FRONT, BACK, 1, 2, state)) count--;
-    if (MATCHES_EITHER_CENTRE(FRONT, BACK, 2, 1, state)) count--;
-    if (MATCHES_EITHER_CENTRE(BACK, FRONT, 1, 2, state)) count--;
-    if (MATCHES_EITHER_CENTRE(BACK, FRONT, 2, 1, state)) count--;
-    return count/3;
+/*
+ * Queue the children of a polled state whose estimated cost is the cost it was polled at, or at most that on
+ * its first expansion, when children costing less than an inconsistent estimate promised are queued too.
+ * Children already expanded through a path at least as short are left out.
+ *
+ * @param[out] next_cost The lowest estimated cost of the children left out for costing more, or
+ *                       EXPANDED_FULLY if none were.
+ * @return               True if every child meant to be queued was.
+ */
+static bool expand_partially(const MoveQueueNode *node, uint32_t parent, bool first, const Heuristic *heuristic,
+                             MoveBucketQueue *queue, HashSet *expanded_states, const ExpandedEntry *entries,
+                             unsigned int *next_cost) {
+    *next_cost = EXPANDED_FULLY;
+    if (node->link.depth == MAXIMUM_MOVEMENTS) {
+        return true;
+    }
+    CubeState current = node->state;
+    CubeState next[MOVES];
+    HeuristicTally tally;
+    HeuristicTally child;
+    PathLink link = { .parent = parent, .depth = node->link.depth + 1 };
+    uint32_t allowed = moves_after(node->link);
+    unsigned int polled = (unsigned int) node->cost;
+    apply_all_movements_to_faces(&current, next);
+
+    heuristic_tally(heuristic, &current, &tally);
+    for (size_t move = 0; move < MOVES; move++) {
+        if (!(allowed >> move & 1u)) continue;
+
+        ssize_t *index = get_offset_from_hash_set(expanded_states, cubestate_key(&next[move]));
+        if (index && entries[*index].depth <= link.depth) continue;
+
+        link.move = movement_from_index(move);
+        unsigned int cost = link.depth + heuristic_update(heuristic, &tally, link.move, &next[move], &child);
+        if (cost == polled || (first && cost < polled)) {
+            if (!add_to_move_bucket_queue(queue, &next[move], link, cost)) {
+                return false;
+            }
+        } else if (cost > polled && cost < *next_cost) {
+            *next_cost = cost;
+        }
+    }
+    return true;
 }
 
-static double misplaced_pieces_heuristic(CubeState *state) {
-    int max = 0;
-    int min = 8;
-    for (Face face = 0; face < FACES; face++) {
-        int count = 0;
-        if (!MATCHES_CENTRE(face, 0, 1, state)) count++;
-        if (!MATCHES_CENTRE(face, 1, 0, state)) count++;
-        if (!MATCHES_CENTRE(face, 1, 2, state)) count++;
-        if (!MATCHES_CENTRE(face, 2, 1, state)) count++;
-        if (MISPLACED_CORNER(face, 0, 0, state)) count++;
-        if (MISPLACED_CORNER(face, 0, 2, state)) count++;
-        if (MISPLACED_CORNER(face, 2, 0, state)) count++;
-        if (MISPLACED_CORNER(face, 2, 2, state)) count++;
-        if (max < count) max = count;
-        if (min > count) min = count;
+SolveResult partial_expansion_solve(CubeState *start, const Heuristic *heuristic, const SolveLimits *limits,
+                                    int *move_count, Movement *solution) {
+    MoveBucketQueue *queue = new_move_bucket_queue(2 * MAXIMUM_MOVEMENTS);
+    HashSet *expanded_states = new_hash_set(100);
+    MoveTrail *trail = new_move_trail(100);
+    size_t entry_count = 0;
+    size_t entry_size = 100;
+    ExpandedEntry *entries = (ExpandedEntry *) malloc(entry_size * sizeof(ExpandedEntry));
+    SolveResult result = SOLVE_NOT_FOUND;
+    MoveQueueNode node;
+    uint64_t expanded = 0;
+
+    bool added = queue && expanded_states && trail && entries
+                 && add_to_move_bucket_queue(queue, start, START_LINK, heuristic_estimate(heuristic, start));
+
+    // A state whose children could not all be queued could hide the shortest solution, so the search stops.
+    while (added && queue->count > 0 && poll_move_bucket_queue(queue, &node)) {
+        ssize_t *offset = get_offset_from_hash_set(expanded_states, node.key);
+        ssize_t index = offset ? *offset : -1;
+        int depth = node.link.depth;
+        bool first = index < 0 || entries[index].depth > depth;
+
+        if (!first && (entries[index].depth < depth || entries[index].cost != (unsigned int) node.cost)) {
+            // A copy of a state already expanded through a path at least as short, and not the state queued again.
+            continue;
+        }
+
+        if (first && solved(&(node.state))) {
+            *move_count = trace_moves(trail, node.link, solution);
+            result = SOLVE_FOUND;
+            break;
+        }
+
+        size_t bytes = search_bytes(queue->count, expanded_states, trail) + entry_size * sizeof(ExpandedEntry);
+        if (solve_limit_reached(limits, expanded++, bytes, &result)) {
+            break;
+        }
+        if (first) {
+            // A state reached again through a shorter path keeps its entry.
+            if (index < 0) {
+                index = add_expanded_entry(&entries, &entry_count, &entry_size);
+                if (index < 0 || !add_to_hash_set(expanded_states, node.key)) {
+                    break;
+                }
+                modify_offset_in_hash_set(expanded_states, node.key, index);
+            }
+            if (!record_expansion(trail, node.link, &(entries[index].parent))) {
+                break;
+            }
+            entries[index].depth = depth;
+        }
+
+        ExpandedEntry *entry = &entries[index];
+        added = expand_partially(&node, entry->parent, first, heuristic, queue, expanded_states, entries,
+                                 &(entry->cost));
+        if (added && entry->cost != EXPANDED_FULLY) {
+            added = add_to_move_bucket_queue(queue, &(node.state), node.link, entry->cost);
+        }
     }
-    return max + min;
+
+    free(entries);
+    free_move_trail(trail);
+    free_hash_set(expanded_states);
+    free_move_bucket_queue(queue);
+
+    return result;
 }
 
-double heuristic(CubeState *state) {
-    double h = 0;
-    if (solved(state)) {
-        return 0;
-    }
-    // add in more future heuristics
-    // h += spot_colour_heuristic(state) * 0;
-    // h += edge_piece_heuristic(state) * 0;
-    // h += corner_piece_heuristic(state) * 0;
-    h += misplaced_pieces_heuristic(state);
-    h += kociemba_heuristic(state) * 0;
-    return h;
+int heuristic(CubeState *state) {
+    return heuristic_estimate(&GREEDY_HEURISTIC, state);
 }
 
-double estimate_cost(CubeState *state) {
-    return heuristic(state) + state->history_count;
+int estimate_cost(CubeState *state, int depth) {
+    return heuristic(state) + depth;
 }
 
-bool expand_all_moves(CubeState *current, MovePriorityQueue *queue, HashTree *visitedHashes) {
-    if (current->history_count == MAXIMUM_MOVEMENTS) {
-        return false;
+bool expand_all_moves(CubeState *current, PathLink reached, uint32_t parent, MoveBucketQueue *queue, HashSet *visitedHashes) {
+    if (reached.depth == MAXIMUM_MOVEMENTS) {
+        return true;
     }
-    CubeState next;
-    Movement movement;
-    for (int direction = 0; direction < 3; direction++) {
-        movement.direction = direction;
-        for (int face = 0; face < 6; face++) {
-            movement.face = face;
-            next = apply_movement(current, movement);
-            if (!query_hash_tree(visitedHashes, hash_cubestate(&next))) {
-                add_to_move_priority_queue(queue, &next, estimate_cost(&next));
+    CubeState next[MOVES];
+    HeuristicTally tally;
+    HeuristicTally child;
+    PathLink link = { .parent = parent, .depth = reached.depth + 1 };
+    uint32_t allowed = moves_after(reached);
+    apply_all_movements_to_faces(current, next);
+
+    // Tally current once, so each child's estimate only counts the faces its movement touched.
+    heuristic_tally(&GREEDY_HEURISTIC, current, &tally);
+    for (size_t move = 0; move < MOVES; move++) {
+        if ((allowed >> move & 1u) && !query_hash_set(visitedHashes, cubestate_key(&next[move]))) {
+            link.move = movement_from_index(move);
+            int h = heuristic_update(&GREEDY_HEURISTIC, &tally, link.move, &next[move], &child);
+            if (!add_to_move_bucket_queue(queue, &next[move], link, h + link.depth)) {
+                return false;
             }
         }
     }
     return true;
 }
 
-bool visit(CubeState *current, HashTree *visitedHashes) {
-    return add_to_hash_tree(visitedHashes, hash_cubestate(current));
+bool visit(CubeState *current, HashSet *visitedHashes) {
+    return add_to_hash_set(visitedHashes, cubestate_key(current));
 }
 
-static bool within_g1(CubeState *state) {
+bool within_g1(CubeState *state) {
     if (
            MATCHES_CENTRE(TOP, 0, 0, state)
         && MATCHES_CENTRE(TOP, 0, 2, state)
@@ -234,32 +300,30 @@ static bool within_g1(CubeState *state) {
     return false;
 }
 
-CubeState k_solve(CubeState *start, int *move_count, Movement *solution) {
-    MovePriorityQueue *queue = new_move_priority_queue(100);
+SolveResult k_solve(CubeState *start, const SolveLimits *limits, int *move_count, Movement *solution,
+                    CubeState *g1_state) {
+    MoveBucketQueue *queue = new_move_bucket_queue(2 * MAXIMUM_MOVEMENTS);
     MoveQueueNode query_result;
-    add_to_move_priority_queue(queue, start, estimate_cost(start));
-    HashTree* visitedHashes = new_hash_tree();
+    add_to_move_bucket_queue(queue, start, START_LINK, estimate_cost(start, 0));
+    HashSet* visitedHashes = new_hash_set(100);
+    MoveTrail *trail = new_move_trail(100);
+    SolveResult result = SOLVE_NOT_FOUND;
+    uint64_t expanded = 0;
+    uint32_t parent;
     int count = 0;
     int count2 = 0;
 
+    *g1_state = *start;
+
     while(queue->count > 0) {
 
         // Get next state from the queue
-        if (!poll_move_priority_queue(queue, &query_result)) {
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
-
-            return *start;
+        if (!poll_move_bucket_queue(queue, &query_result)) {
+            break;
         }
         count2++;
 
-        if ((queue->count > 4000000) && 0) {
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
-            return *start;
-        }
-
-        if ((query_result.state.history_count > count) && 0) {
+        if ((query_result.link.depth > count) && 0) {
 
             printf("%d count\t", ++count);
             printf("%d count\t", count2);
@@ -268,82 +332,111 @@ CubeState k_solve(CubeState *start, int *move_count, Movement *solution) {
         }
 
         if (!visit(&(query_result.state), visitedHashes)) {
-            fprintf(stderr, "visited before, shouldn't have been in queue!\n");
+            // A copy of a state already expanded through a path at least as cheap.
             continue;
         }
 
         if (within_g1(&(query_result.state))) {
-            *move_count = query_result.state.history_count;
-            memcpy(solution, query_result.state.history, sizeof(query_result.state.history));
-
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
+            *move_count = trace_moves(trail, query_result.link, solution);
+            *g1_state = query_result.state;
+            result = SOLVE_FOUND;
+            break;
+        }
 
-            return query_result.state;
+        if (solve_limit_reached(limits, expanded++, search_bytes(queue->count, visitedHashes, trail), &result)
+                || !record_expansion(trail, query_result.link, &parent)) {
+            break;
         }
 
-        expand_all_moves(&(query_result.state), queue, visitedHashes);
+        // A child dropped for want of memory could be the way to the goal, so the search stops instead.
+        if (!expand_all_moves(&(query_result.state), query_result.link, parent, queue, visitedHashes)) {
+            break;
+        }
     }
 
-    free_hash_tree(visitedHashes);
-    free_move_priority_queue(queue);
+    free_move_trail(trail);
+    free_hash_set(visitedHashes);
+    free_move_bucket_queue(queue);
 
-    return *start;
+    return result;
 }
 
-static bool expand_g1_moves(CubeState *current, MovePriorityQueue *queue, HashTree *visitedHashes) {
-    if (current->history_count == MAXIMUM_MOVEMENTS) {
+/*
+ * Estimate g1_solve orders half turns of the side faces by: 36 less the facelets matching their centre,
+ * centres included, over 12. Its fractions and its offset against the greedy estimate of the quarter
+ * turns decide how the two kinds of turn interleave, so it is kept as it was rather than made integral.
+ */
+static double spot_colour_priority(CubeState *state) {
+    double count = 36;
+    for (int face = TOP; face < FACES; face++) {
+        for (int row = 0; row < SIDE_LENGTH; row++) {
+            for (int col = 0; col < SIDE_LENGTH; col++) {
+                if (MATCHES_CENTRE(face, row, col, state)) {
+                    count--;
+                }
+            }
+        }
+    }
+    return count / 12;
+}
+
+static bool expand_g1_moves(CubeState *current, PathLink reached, uint32_t parent, MovePriorityQueue *queue, HashSet *visitedHashes) {
+    if (reached.depth == MAXIMUM_MOVEMENTS) {
         return false;
     }
     CubeState next;
-    Movement movement;
+    HeuristicTally greedy;
+    HeuristicTally child;
+    PathLink link = { .parent = parent, .depth = reached.depth + 1 };
+    uint32_t allowed = moves_after(reached);
+    heuristic_tally(&GREEDY_HEURISTIC, current, &greedy);
     for (int direction = 0; direction < 3; direction++) {
-        movement.direction = direction;
         for (int face = 0; face < 6; face += 5) { // all moves top and bottom
-            movement.face = face;
-            next = apply_movement(current, movement);
-            if (!query_hash_tree(visitedHashes, hash_cubestate(&next))) {
-                add_to_move_priority_queue(queue, &next, estimate_cost(&next));
+            if (!(allowed & FaceMoves(face))) continue;
+            link.move = movement_from_index(face * 3 + direction);
+            apply_movement_to_faces(current, link.move, &next);
+            if (!query_hash_set(visitedHashes, cubestate_key(&next))) {
+                int h = heuristic_update(&GREEDY_HEURISTIC, &greedy, link.move, &next, &child);
+                add_to_move_priority_queue(queue, &next, link, h + link.depth);
             }
         }
     }
-    movement.direction = DOUBLE;
     for (int face = 1; face < 5; face++) { // F2, L2, B2, R2
-        movement.face = face;
-        next = apply_movement(current, movement);
-        if (!query_hash_tree(visitedHashes, hash_cubestate(&next))) {
-            add_to_move_priority_queue(queue, &next, spot_colour_heuristic(&next) + next.history_count);
+        if (!(allowed & FaceMoves(face))) continue;
+        link.move = movement_from_index(face * 3 + DOUBLE);
+        apply_movement_to_faces(current, link.move, &next);
+        if (!query_hash_set(visitedHashes, cubestate_key(&next))) {
+            add_to_move_priority_queue(queue, &next, link, spot_colour_priority(&next) + link.depth);
         }
     }
     return true;
 }
 
-bool g1_solve(CubeState *start, int *move_count, Movement *solution) {
+SolveResult g1_solve(CubeState *start, const SolveLimits *limits, int *move_count, Movement *solution) {
     MovePriorityQueue *queue = new_move_priority_queue(100);
     MoveQueueNode query_result;
-    add_to_move_priority_queue(queue, start, estimate_cost(start));
-    HashTree* visitedHashes = new_hash_tree();
+    add_to_move_priority_queue(queue, start, START_LINK, estimate_cost(start, 0));
+    HashSet* visitedHashes = new_hash_set(100);
+    MoveTrail *trail = new_move_trail(100);
+    SolveResult result = SOLVE_NOT_FOUND;
+    uint64_t expanded = 0;
+    uint32_t parent;
     int count = 0;
     int count2 = 0;
 
+    if (!limits) {
+        limits = &G1_DEFAULT_LIMITS;
+    }
+
     while(queue->count > 0) {
 
         // Get next state from the queue
         if (!poll_move_priority_queue(queue, &query_result)) {
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
-
-            return false;
+            break;
         }
         count2++;
 
-        if (queue->count > 4000000) {
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
-            return false;
-        }
-
-        if (query_result.state.history_count > count) {
+        if (query_result.link.depth > count) {
 
             printf("%d count\t", ++count);
             printf("%d count\t", count2);
@@ -357,20 +450,22 @@ bool g1_solve(CubeState *start, int *move_count, Movement *solution) {
         }
 
         if (solved(&(query_result.state))) {
-            *move_count = query_result.state.history_count;
-            memcpy(solution, query_result.state.history, sizeof(query_result.state.history));
-
-            free_hash_tree(visitedHashes);
-            free_move_priority_queue(queue);
+            *move_count = trace_moves(trail, query_result.link, solution);
+            result = SOLVE_FOUND;
+            break;
+        }
 
-            return true;
+        if (solve_limit_reached(limits, expanded++, search_bytes(queue->count, visitedHashes, trail), &result)
+                || !record_expansion(trail, query_result.link, &parent)) {
+            break;
         }
 
-        expand_g1_moves(&(query_result.state), queue, visitedHashes);
+        expand_g1_moves(&(query_result.state), query_result.link, parent, queue, visitedHashes);
     }
 
-    free_hash_tree(visitedHashes);
+    free_move_trail(trail);
+    free_hash_set(visitedHashes);
     free_move_priority_queue(queue);
 
-    return false;
+    return result;
 }
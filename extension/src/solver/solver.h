@@ -1,9 +1,13 @@
 #ifndef __SOLVER_H__
 #define __SOLVER_H__
 
+#include "bucketqueue.h"
 #include "cubestate.h"
-#include "hashtree.h"
+#include "hashset.h"
+#include "heuristic.h"
 #include "movequeue.h"
+#include "movetrail.h"
+#include "solvelimits.h"
 
 #define MATCHES_CENTRE(f, r, c, cube) (cube->data[f][r][c] == cube->data[f][1][1])
 #define MISPLACED_CORNER(f, r, c, cube) (cube->data[f][r][c] != cube->data[f][r][1] && cube->data[f][r][c] != cube->data[f][1][c])
@@ -12,77 +16,116 @@
 /**
  * Finds a solution set of moves for a cube starting in position represented by start.
  *
- * @param[in]   start       The starting position, history should be empty.
+ * @param[in]   start       The starting position.
+ * @param[in]   limits      Bounds on the search, or NULL for none.
  * @param[out]  move_count  The number of moves in the solution.
  * @param[out]  solution    An array of moves which transform start to a solved cube
- * @return                  True if a solution was found.
+ * @return                  SOLVE_FOUND if a solution was found, otherwise why not.
  *
  */
-bool solve(CubeState *start, int *move_count, Movement* solution);
+SolveResult solve(CubeState *start, const SolveLimits *limits, int *move_count, Movement* solution);
 
 /**
- * Calculates estimated distance from state to a solved state.
+ * Finds a solution set of moves for a cube with partial expansion A*.
+ * An expanded state only queues its children whose estimated cost is the cost it was polled at, and is
+ * queued again at the lowest cost of the rest. The queue then holds far fewer states that are never
+ * polled, at the price of estimating children again each time their parent is polled.
+ * With an admissible heuristic the solution is a shortest one.
+ *
+ * @param[in]   start       The starting position.
+ * @param[in]   heuristic   Heuristic to estimate with, e.g. GREEDY_HEURISTIC as solve uses.
+ * @param[in]   limits      Bounds on the search, or NULL for none.
+ * @param[out]  move_count  The number of moves in the solution.
+ * @param[out]  solution    An array of moves which transform start to a solved cube.
+ * @return                  SOLVE_FOUND if a solution was found, otherwise why not.
+ *
+ */
+SolveResult partial_expansion_solve(CubeState *start, const Heuristic *heuristic, const SolveLimits *limits,
+                                    int *move_count, Movement *solution);
+
+/**
+ * Calculates estimated distance from state to a solved state, using GREEDY_HEURISTIC.
  *
  * @param state The state to calculate a heuristic for
  * @return      The heuristic value
  *
  */
-double heuristic(CubeState *state);
+int heuristic(CubeState *state);
 
 /**
  * Calculates estimated cost of a solution through state.
  *
  * @param state The state to calculate a heuristic for
+ * @param depth The number of moves taken to reach state
  * @return      The estimated cost.
  *
  */
-double estimate_cost(CubeState *state);
+int estimate_cost(CubeState *state, int depth);
 
 /**
  * Adds all states reachable in a single move from current to queue which have not yet been visited
+ * Only movements allowed by CANONICAL_MOVES after the movement which reached current are taken.
  *
  * @param[in]  current          The state to move from.
+ * @param[in]  reached          How the search reached current.
+ * @param[in]  parent           Trail index of current's link, or NO_PARENT if current is the start state.
  * @param[out] queue            The queue to add the new states too.
- * @param[in]  visitedHashes    A searchable array of hashes that should not be re-added.
- * @return                      True if the state was successfully expanded.
+ * @param[in]  visitedHashes    A searchable set of state keys that should not be re-added.
+ * @return                      True unless a state could not be queued for want of memory.
  *
  */
-bool expand_all_moves(CubeState *current, MovePriorityQueue *queue, HashTree *visitedHashes);
+bool expand_all_moves(CubeState *current, PathLink reached, uint32_t parent, MoveBucketQueue *queue, HashSet *visitedHashes);
 
 /**
- * Checks whether the hash for current state is in visitedHashes
+ * Checks whether the key for current state is in visitedHashes
  * and adds it if not there
+ * States are keyed exactly. Keying by class of conjugates was tried, but a scramble is rarely near
+ * its own conjugates, so it saved almost no expansions while costing 47 conjugations a state.
  *
  * @param   current         The state to check.
- * @param   visitedHashes   A searchable array of hashes.
+ * @param   visitedHashes   A searchable set of state keys.
  * @return                  True if it has been added (it was not previously visited).
  */
-bool visit(CubeState *current, HashTree *visitedHashes);
+bool visit(CubeState *current, HashSet *visitedHashes);
 
 
+/**
+ * Checks whether a state is in G1: every TOP and BOTTOM facelet is the colour of either centre,
+ * and so is every FRONT and BACK facelet of the middle layer.
+ *
+ * @param state The state to check.
+ * @return      True if state is in G1.
+ *
+ */
+bool within_g1(CubeState *state);
+
 /**
  * Finds a set of moves to put start into a position in G1.
  *
- * @param[in]   start       The starting position, history should be empty.
+ * @param[in]   start       The starting position.
+ * @param[in]   limits      Bounds on the search, or NULL for none.
  * @param[out]  move_count  The number of moves in the solution.
- * @param[out]  solution    An array of moves which transform start to a solved cube
- * @return                  The state in G1 that was reached.
+ * @param[out]  solution    An array of moves which transform start to a position in G1.
+ * @param[out]  g1_state    The state in G1 that was reached, or start if none was.
+ * @return                  SOLVE_FOUND if a position in G1 was reached, otherwise why not.
  *
  */
-CubeState k_solve(CubeState *start, int *move_count, Movement* solution);
+SolveResult k_solve(CubeState *start, const SolveLimits *limits, int *move_count, Movement* solution,
+                    CubeState *g1_state);
 
 
 /**
  * Finds a solution set of moves for a cube starting in position represented by start.
  * pre: start must be in G1.
  *
- * @param[in]   start       The starting position, history should be empty.
+ * @param[in]   start       The starting position.
+ * @param[in]   limits      Bounds on the search, or NULL to stop once about 4000000 states are queued.
  * @param[out]  move_count  The number of moves in the solution.
  * @param[out]  solution    An array of moves which transform start to a solved cube
- * @return                  True if a solution was found.
+ * @return                  SOLVE_FOUND if a solution was found, otherwise why not.
  *
  */
-bool g1_solve(CubeState *start, int *move_count, Movement* solution);
+SolveResult g1_solve(CubeState *start, const SolveLimits *limits, int *move_count, Movement* solution);
 
 
 
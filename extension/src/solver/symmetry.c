@@ -0,0 +1,150 @@
+#include "symmetry.h"
+
+#include <pthread.h>
+
+// A 120 degree clockwise turn about the URF - DBL diagonal.
+static const CubieState URF3_CUBIES = {
+    .corners = {
+        PackCorner(TOP_RIGHT_FRONT, 1), PackCorner(BOTTOM_FRONT_RIGHT, 2),
+        PackCorner(BOTTOM_LEFT_FRONT, 1), PackCorner(TOP_FRONT_LEFT, 2),
+        PackCorner(TOP_BACK_RIGHT, 2), PackCorner(BOTTOM_RIGHT_BACK, 1),
+        PackCorner(BOTTOM_BACK_LEFT, 2), PackCorner(TOP_LEFT_BACK, 1)
+    },
+    .edges = {
+        PackEdge(TOP_FRONT, 1), PackEdge(FRONT_RIGHT, 0), PackEdge(BOTTOM_FRONT, 1), PackEdge(FRONT_LEFT, 0),
+        PackEdge(TOP_BACK, 1), PackEdge(BACK_RIGHT, 0), PackEdge(BOTTOM_BACK, 1), PackEdge(BACK_LEFT, 0),
+        PackEdge(TOP_RIGHT, 1), PackEdge(BOTTOM_RIGHT, 1), PackEdge(BOTTOM_LEFT, 1), PackEdge(TOP_LEFT, 1)
+    }
+};
+
+// A half turn about the FRONT - BACK axis.
+static const CubieState F2_CUBIES = {
+    .corners = {
+        PackCorner(BOTTOM_LEFT_FRONT, 0), PackCorner(BOTTOM_FRONT_RIGHT, 0),
+        PackCorner(BOTTOM_RIGHT_BACK, 0), PackCorner(BOTTOM_BACK_LEFT, 0),
+        PackCorner(TOP_FRONT_LEFT, 0), PackCorner(TOP_RIGHT_FRONT, 0),
+        PackCorner(TOP_BACK_RIGHT, 0), PackCorner(TOP_LEFT_BACK, 0)
+    },
+    .edges = {
+        PackEdge(BOTTOM_LEFT, 0), PackEdge(BOTTOM_FRONT, 0), PackEdge(BOTTOM_RIGHT, 0), PackEdge(BOTTOM_BACK, 0),
+        PackEdge(TOP_LEFT, 0), PackEdge(TOP_FRONT, 0), PackEdge(TOP_RIGHT, 0), PackEdge(TOP_BACK, 0),
+        PackEdge(FRONT_LEFT, 0), PackEdge(FRONT_RIGHT, 0), PackEdge(BACK_RIGHT, 0), PackEdge(BACK_LEFT, 0)
+    }
+};
+
+// A quarter turn clockwise about the TOP - BOTTOM axis.
+static const CubieState U4_CUBIES = {
+    .corners = {
+        PackCorner(TOP_BACK_RIGHT, 0), PackCorner(TOP_RIGHT_FRONT, 0),
+        PackCorner(TOP_FRONT_LEFT, 0), PackCorner(TOP_LEFT_BACK, 0),
+        PackCorner(BOTTOM_RIGHT_BACK, 0), PackCorner(BOTTOM_FRONT_RIGHT, 0),
+        PackCorner(BOTTOM_LEFT_FRONT, 0), PackCorner(BOTTOM_BACK_LEFT, 0)
+    },
+    .edges = {
+        PackEdge(TOP_BACK, 0), PackEdge(TOP_RIGHT, 0), PackEdge(TOP_FRONT, 0), PackEdge(TOP_LEFT, 0),
+        PackEdge(BOTTOM_BACK, 0), PackEdge(BOTTOM_RIGHT, 0), PackEdge(BOTTOM_FRONT, 0), PackEdge(BOTTOM_LEFT, 0),
+        PackEdge(BACK_RIGHT, 1), PackEdge(FRONT_RIGHT, 1), PackEdge(FRONT_LEFT, 1), PackEdge(BACK_LEFT, 1)
+    }
+};
+
+// The mirror through the TOP, FRONT, BOTTOM and BACK centres. A twist of 3 marks a mirrored corner.
+static const CubieState LR2_CUBIES = {
+    .corners = {
+        PackCorner(TOP_FRONT_LEFT, 3), PackCorner(TOP_RIGHT_FRONT, 3),
+        PackCorner(TOP_BACK_RIGHT, 3), PackCorner(TOP_LEFT_BACK, 3),
+        PackCorner(BOTTOM_LEFT_FRONT, 3), PackCorner(BOTTOM_FRONT_RIGHT, 3),
+        PackCorner(BOTTOM_RIGHT_BACK, 3), PackCorner(BOTTOM_BACK_LEFT, 3)
+    },
+    .edges = {
+        PackEdge(TOP_LEFT, 0), PackEdge(TOP_FRONT, 0), PackEdge(TOP_RIGHT, 0), PackEdge(TOP_BACK, 0),
+        PackEdge(BOTTOM_LEFT, 0), PackEdge(BOTTOM_FRONT, 0), PackEdge(BOTTOM_RIGHT, 0), PackEdge(BOTTOM_BACK, 0),
+        PackEdge(FRONT_LEFT, 0), PackEdge(FRONT_RIGHT, 0), PackEdge(BACK_RIGHT, 0), PackEdge(BACK_LEFT, 0)
+    }
+};
+
+static CubieState symmetries[SYMMETRIES];
+static uint8_t inverses[SYMMETRIES];
+// Parallel solvers may reduce by symmetry from several threads at once, so the tables are built under a once.
+static pthread_once_t symmetries_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Apply b after a. Twists of 3 to 5 mark mirrored corners, which turn the other way,
+ * so a mirrored corner subtracts rather than adds twist.
+ */
+static CubieState multiply_cubies(const CubieState *a, const CubieState *b) {
+    CubieState product;
+
+    for (size_t i = 0; i < CORNERS; ++i) {
+        uint8_t from = a->corners[CornerCubie(b->corners[i])];
+        int twist_a = CornerTwist(from);
+        int twist_b = CornerTwist(b->corners[i]);
+        int twist;
+
+        if (twist_a < 3 && twist_b < 3) {
+            twist = (twist_a + twist_b) % 3;
+        } else if (twist_a < 3) {
+            twist = twist_a + twist_b;
+            twist = twist >= 6 ? twist - 3 : twist;
+        } else if (twist_b < 3) {
+            twist = twist_a - twist_b;
+            twist = twist < 3 ? twist + 3 : twist;
+        } else {
+            twist = twist_a - twist_b;
+            twist = twist < 0 ? twist + 3 : twist;
+        }
+
+        product.corners[i] = PackCorner(CornerCubie(from), twist);
+    }
+
+    for (size_t i = 0; i < EDGES; ++i) {
+        uint8_t from = a->edges[EdgeCubie(b->edges[i])];
+        product.edges[i] = from ^ PackEdge(0, EdgeFlip(b->edges[i]));
+    }
+
+    return product;
+}
+
+static void init_symmetries(void) {
+    CubieState cubies = SOLVED_CUBIES;
+    int symmetry = 0;
+
+    for (int urf3 = 0; urf3 < 3; ++urf3) {
+        for (int f2 = 0; f2 < 2; ++f2) {
+            for (int u4 = 0; u4 < 4; ++u4) {
+                for (int lr2 = 0; lr2 < 2; ++lr2) {
+                    symmetries[symmetry++] = cubies;
+                    cubies = multiply_cubies(&cubies, &LR2_CUBIES);
+                }
+                cubies = multiply_cubies(&cubies, &U4_CUBIES);
+            }
+            cubies = multiply_cubies(&cubies, &F2_CUBIES);
+        }
+        cubies = multiply_cubies(&cubies, &URF3_CUBIES);
+    }
+
+    for (int s = 0; s < SYMMETRIES; ++s) {
+        for (int t = 0; t < SYMMETRIES; ++t) {
+            CubieState product = multiply_cubies(&symmetries[s], &symmetries[t]);
+            if (cubies_solved(&product)) {
+                inverses[s] = t;
+                break;
+            }
+        }
+    }
+}
+
+const CubieState *symmetry_cubies(int symmetry) {
+    pthread_once(&symmetries_once, init_symmetries);
+    return &symmetries[symmetry];
+}
+
+int inverse_symmetry(int symmetry) {
+    pthread_once(&symmetries_once, init_symmetries);
+    return inverses[symmetry];
+}
+
+CubieState conjugate_cubies(const CubieState *cubies, int symmetry) {
+    pthread_once(&symmetries_once, init_symmetries);
+    CubieState left = multiply_cubies(&symmetries[inverses[symmetry]], cubies);
+    return multiply_cubies(&left, &symmetries[symmetry]);
+}
@@ -0,0 +1,55 @@
+#ifndef __SYMMETRY_H__
+#define __SYMMETRY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cubestate.h"
+
+/*
+ * Symmetries of the cube: the rotations and reflections that map the cube onto itself.
+ *
+ * Conjugating a cube C by a symmetry S gives S^-1 C S: the same cube seen rotated or in a mirror.
+ * Every movement conjugates to another movement, and the solved cube to itself, so a cube and its
+ * conjugates are the same number of movements from solved. Pattern databases can keep one entry
+ * for each class of conjugates instead of one for every cube.
+ *
+ * Symmetries are numbered 16 * urf3 + 8 * f2 + 2 * u4 + lr2, composing in that order:
+ * a 120 degree turn about the corner URF - DBL diagonal, a half turn about the FRONT - BACK axis,
+ * a quarter turn about the TOP - BOTTOM axis, and the mirror swapping LEFT and RIGHT.
+ * The first UD_SYMMETRIES keep the TOP - BOTTOM axis in place, and so also preserve G1.
+ */
+
+// Number of symmetries of the cube.
+#define SYMMETRIES    48
+// Number of symmetries that keep the TOP - BOTTOM axis in place.
+#define UD_SYMMETRIES 16
+
+/**
+ * Get the cube a symmetry is made of, as the arrangement of cubies it gives a solved cube.
+ * Mirrored symmetries give corners twists of 3 to 5, which only ever appear in these cubes.
+ *
+ * @param  symmetry Symmetry to get, 0 to SYMMETRIES - 1.
+ * @return          Its cubies.
+ */
+const CubieState *symmetry_cubies(int symmetry);
+
+/**
+ * Get the symmetry that undoes another.
+ *
+ * @param  symmetry Symmetry to invert.
+ * @return          Its inverse.
+ */
+int inverse_symmetry(int symmetry);
+
+/**
+ * Conjugate a cube by a symmetry.
+ *
+ * @param  cubies   Cube to conjugate.
+ * @param  symmetry Symmetry to conjugate by.
+ * @return          S^-1 C S, for S the symmetry and C the cube.
+ */
+CubieState conjugate_cubies(const CubieState *cubies, int symmetry);
+
+#endif  // __SYMMETRY_H__
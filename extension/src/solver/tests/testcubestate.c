@@ -1,5 +1,6 @@
 #include "../../../testsuite/testsuite.h"
 #include "../cubestate.h"
+#include "../movekernel.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -47,6 +48,59 @@ static void test_hash_cubestate(void) {
     assert_uint_not_equals(0ul, hash_cubestate(&state));
 }
 
+static void test_state_keys_are_exact(void) {
+    CubeState moved[MOVES], state;
+
+    memcpy(&state, &EXAMPLE_SCRAMBLED_STATE, sizeof(CubeState));
+    assert_sint_equals(0, compare_state_keys(cubestate_key(&state), cubestate_key(&EXAMPLE_SCRAMBLED_STATE)));
+
+    // Every facelet outside the centres must show up in the key.
+    for (size_t f = 0; f < FACES; ++f) {
+        for (size_t r = 0; r < SIDE_LENGTH; ++r) {
+            for (size_t c = 0; c < SIDE_LENGTH; ++c) {
+                if (r == SIDE_LENGTH / 2 && c == SIDE_LENGTH / 2) {
+                    continue;
+                }
+                state.data[f][r][c] = (state.data[f][r][c] + 1) % COLOURS;
+                assert_sint_not_equals(0, compare_state_keys(cubestate_key(&state), cubestate_key(&EXAMPLE_SCRAMBLED_STATE)));
+                state.data[f][r][c] = EXAMPLE_SCRAMBLED_STATE.data[f][r][c];
+            }
+        }
+    }
+
+    apply_all_movements_to_faces(&EXAMPLE_SOLVED_STATE, moved);
+    for (size_t i = 0; i < MOVES; ++i) {
+        for (size_t j = i + 1; j < MOVES; ++j) {
+            assert_sint_not_equals(0, compare_state_keys(cubestate_key(&moved[i]), cubestate_key(&moved[j])));
+        }
+    }
+}
+
+static void test_canonical_moves(void) {
+    const Face OPPOSITES[FACES] = { BOTTOM, BACK, RIGHT, FRONT, LEFT, TOP };
+    size_t sequences = 0;
+
+    assert_uint_equals(ALL_MOVES, CANONICAL_MOVES[FACES]);
+
+    for (Face first = 0; first < FACES; ++first) {
+        Face opposite = OPPOSITES[first];
+
+        assert_uint_equals(0u, CANONICAL_MOVES[first] & FaceMoves(first));
+
+        // Exactly one order of each pair of opposite faces is allowed.
+        bool forward = CANONICAL_MOVES[first] & FaceMoves(opposite);
+        bool backward = CANONICAL_MOVES[opposite] & FaceMoves(first);
+        assert_true(forward != backward);
+
+        for (size_t move = 0; move < MOVES; ++move) {
+            sequences += 3u * (CANONICAL_MOVES[first] >> move & 1u);
+        }
+    }
+
+    // 18 first movements, then 15 or 12 second movements depending on the first face.
+    assert_uint_equals(9u * 15u + 9u * 12u, sequences);
+}
+
 static void test_solved_check(void) {
     assert_true(solved(&EXAMPLE_SOLVED_STATE));
     assert_false(solved(&EXAMPLE_UNSOLVED_STATE));
@@ -64,12 +118,98 @@ static void test_movements(void) {
     printCubeState(&state);
 }
 
-static const Test TESTS[5] = {
+static void test_movement_tables_match_unfolding(void) {
+    CubeState state, by_table, by_unfolding;
+
+    memcpy(&state, &EXAMPLE_SCRAMBLED_STATE, sizeof(CubeState));
+
+    for (size_t move = 0; move < MOVES; ++move) {
+        by_table = apply_movement(&state, movement_from_index(move));
+        by_unfolding = apply_movement_by_unfolding(&state, movement_from_index(move));
+
+        assert_equals(by_unfolding.data, by_table.data, sizeof(FaceData));
+    }
+}
+
+static void test_move_kernels_agree(void) {
+    const UColour *from = (const UColour *) EXAMPLE_SCRAMBLED_STATE.data;
+    MoveKernelType best = active_move_kernel();
+    UColour expected[MOVES][FACELETS];
+    UColour single[FACELETS];
+    CubeState batch[MOVES];
+
+    assert_true(select_move_kernel(MOVE_KERNEL_SCALAR));
+    move_facelets_all(from, expected[0], FACELETS);
+
+    for (MoveKernelType type = MOVE_KERNEL_SCALAR; type <= MOVE_KERNEL_AVX2; ++type) {
+        if (!select_move_kernel(type)) {
+            fprintf(stderr, "Kernel %d is not supported, skipping.\n", type);
+            continue;
+        }
+
+        move_facelets_all(from, (UColour *) batch[0].data, sizeof(CubeState));
+        for (size_t move = 0; move < MOVES; ++move) {
+            move_facelets(from, movement_from_index(move), single);
+
+            assert_equals(expected[move], single, FACELETS);
+            assert_equals(expected[move], batch[move].data, FACELETS);
+        }
+    }
+
+    assert_true(select_move_kernel(best));
+}
+
+static void test_cubie_conversion_round_trip(void) {
+    CubieState cubies;
+    CubeState converted;
+    UColour centres[FACES];
+
+    for (size_t f = 0; f < FACES; ++f) {
+        centres[f] = EXAMPLE_SCRAMBLED_STATE.data[f][1][1];
+    }
+
+    assert_true(cubies_from_state(&EXAMPLE_SOLVED_STATE, &cubies));
+    assert_true(cubies_solved(&cubies));
+
+    assert_true(cubies_from_state(&EXAMPLE_SCRAMBLED_STATE, &cubies));
+    assert_false(cubies_solved(&cubies));
+
+    state_from_cubies(&cubies, centres, &converted);
+    assert_equals(EXAMPLE_SCRAMBLED_STATE.data, converted.data, sizeof(FaceData));
+}
+
+static void test_cubie_movements_match_face_movements(void) {
+    CubeState state, moved;
+    CubieState cubies, expected;
+
+    memcpy(&state, &EXAMPLE_SOLVED_STATE, sizeof(CubeState));
+    assert_true(cubies_from_state(&state, &cubies));
+
+    srand(1u);
+    for (int n = 0; n < 200; ++n) {
+        Movement movement = movement_from_index(rand() % MOVES);
+
+        moved = apply_movement_by_unfolding(&state, movement);
+        memcpy(state.data, moved.data, sizeof(FaceData));
+        cubies = apply_cubie_movement(&cubies, movement);
+
+        assert_true(cubies_from_state(&state, &expected));
+        assert_equals(&expected, &cubies, sizeof(CubieState));
+    }
+}
+
+static const Test TESTS[11] = {
     { .test = test_movement_packing, .name = "Movement is successfully packed into one byte" },
     { .test = test_movement_still_allows_all_enums, .name = "Movements still have the full range of enums available" },
     { .test = test_hash_cubestate, .name = "Hash cube state does not error during calculation" },
+    { .test = test_canonical_moves, .name = "Canonical movements skip repeated faces and one order of opposite faces" },
+    { .test = test_state_keys_are_exact, .name = "State keys tell apart every pair of different states" },
     { .test = test_solved_check, .name = "Solved function detects correctly"},
-    { .test = test_movements, .name = "Apply movement works correctly"}
+    { .test = test_movements, .name = "Apply movement works correctly"},
+    { .test = test_movement_tables_match_unfolding, .name = "Movement tables match the unfolding movement" },
+    { .test = test_move_kernels_agree, .name = "Every supported movement kernel gives the same result" },
+    { .test = test_cubie_conversion_round_trip, .name = "Cubie conversion is lossless" },
+    { .test = test_cubie_movements_match_face_movements, .name = "Cubie movements match face movements" }
 };
 
 int main(void) {
@@ -0,0 +1,90 @@
+#include "../../../testsuite/testsuite.h"
+#include "../cubestate.h"
+#include "../hashset.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Enough keys to force the set to grow several times from its minimum size.
+#define TEST_KEYS 1000u
+
+static HashSet *test_set;
+
+static StateKey test_key(size_t i) {
+    return (StateKey) { .high = i % 7u, .low = i * 0x10001u };
+}
+
+static void test_add_and_query(void) {
+    for (size_t i = 0; i < TEST_KEYS; ++i) {
+        assert_true(add_to_hash_set(test_set, test_key(i)));
+    }
+
+    assert_uint_equals(TEST_KEYS, test_set->count);
+
+    for (size_t i = 0; i < TEST_KEYS; ++i) {
+        assert_true(query_hash_set(test_set, test_key(i)));
+    }
+
+    assert_false(query_hash_set(test_set, test_key(TEST_KEYS)));
+}
+
+static void test_duplicates_rejected(void) {
+    assert_false(add_to_hash_set(test_set, test_key(0)));
+    assert_false(add_to_hash_set(test_set, test_key(TEST_KEYS - 1u)));
+
+    assert_uint_equals(TEST_KEYS, test_set->count);
+}
+
+static void test_offsets(void) {
+    assert_true(get_offset_from_hash_set(test_set, test_key(5)) == NULL);
+
+    assert_true(modify_offset_in_hash_set(test_set, test_key(5), 42));
+    ssize_t *offset = get_offset_from_hash_set(test_set, test_key(5));
+    assert_true(offset != NULL);
+    assert_sint_equals(42, *offset);
+
+    assert_true(modify_offset_in_hash_set(test_set, test_key(5), NOT_IN_QUEUE));
+    assert_true(get_offset_from_hash_set(test_set, test_key(5)) == NULL);
+    assert_true(query_hash_set(test_set, test_key(5)));
+
+    assert_false(modify_offset_in_hash_set(test_set, test_key(TEST_KEYS), 0));
+}
+
+static void test_offsets_survive_growth(void) {
+    HashSet *set = new_hash_set(0);
+    assert(set);
+
+    for (size_t i = 0; i < TEST_KEYS; ++i) {
+        assert_true(add_to_hash_set(set, test_key(i)));
+        assert_true(modify_offset_in_hash_set(set, test_key(i), i));
+    }
+
+    for (size_t i = 0; i < TEST_KEYS; ++i) {
+        ssize_t *offset = get_offset_from_hash_set(set, test_key(i));
+        assert_true(offset != NULL);
+        assert_sint_equals(i, *offset);
+    }
+
+    assert(free_hash_set(set));
+}
+
+static const Test TESTS[4] = {
+    { .test = test_add_and_query, .name = "Added keys can be found in the set" },
+    { .test = test_duplicates_rejected, .name = "Adding a key twice is rejected" },
+    { .test = test_offsets, .name = "Queue offsets can be modified and queried" },
+    { .test = test_offsets_survive_growth, .name = "Queue offsets are kept when the set grows" }
+};
+
+int main(void) {
+    fprintf(stderr, "--- %s ---\n", __FILE__);
+    test_set = new_hash_set(4);
+    assert(test_set);
+
+    run_tests(TESTS, sizeof(TESTS) / sizeof(Test));
+
+    assert(free_hash_set(test_set));
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include "../../../testsuite/testsuite.h"
+#include "../bucketqueue.h"
 #include "../cubestate.h"
 #include "../movequeue.h"
+#include "../movetrail.h"
 
 #include <assert.h>
 #include <stdint.h>
@@ -41,19 +43,17 @@ static const CubeState TEST_STATE = {
             { WHITE, WHITE, WHITE },
             { WHITE, WHITE, WHITE }
         }
-    },
-    .history_count = 0u,
-    .history = { { .face = TOP, .direction = CW } }
+    }
 };
 
 static void test_add_to_queue(void) {
-    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, 5));
+    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, START_LINK, 5));
     fprintf(stderr, "Count: %zu\n", test_queue->count);
-    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, 4));
+    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, START_LINK, 4));
     fprintf(stderr, "Count: %zu\n", test_queue->count);
-    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, 3));
+    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, START_LINK, 3));
     fprintf(stderr, "Count: %zu\n", test_queue->count);
-    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, 2));
+    assert_true(add_to_move_priority_queue(test_queue, &TEST_STATE, START_LINK, 2));
     fprintf(stderr, "Count: %zu\n", test_queue->count);
 }
 
@@ -69,21 +69,126 @@ static void test_poll_from_queue(void) {
 }
 
 static void test_queue_underflow(void) {
-    MoveQueueNode result = { .state = TEST_STATE, .hash = 0u, .cost = 0u };
+    MoveQueueNode result = { .state = TEST_STATE, .key = { 0u, 0u }, .cost = 0u };
 
     poll_move_priority_queue(test_queue, &result);
 
     assert_sint_equals(MQ_UNDERFLOW, test_queue->error);
-    assert_uint_equals(0u, result.hash);
+    assert_uint_equals(0u, result.key.high);
+    assert_uint_equals(0u, result.key.low);
     assert_uint_equals(0u, result.cost);
 
     assert_sint_equals(0, memcmp(&result.state, &TEST_STATE, sizeof(CubeState)));
 }
 
-static const Test TESTS[3] = {
+static void test_distinct_states_polled_in_order(void) {
+    MovePriorityQueue *queue = new_move_priority_queue(1);
+    MoveQueueNode result;
+    CubeState states[MOVES];
+
+    assert(queue);
+
+    // Distinct states force the pool to grow, and are added out of cost order.
+    apply_all_movements_to_faces(&TEST_STATE, states);
+    for (size_t move = 0; move < MOVES; ++move) {
+        assert_true(add_to_move_priority_queue(queue, &states[move], START_LINK, (move * 7u) % MOVES));
+    }
+    assert_uint_equals(MOVES, queue->count);
+
+    // Lowering a cost moves the state forward without adding it again.
+    assert_true(add_to_move_priority_queue(queue, &states[MOVES - 1u], START_LINK, -1.0));
+    assert_uint_equals(MOVES, queue->count);
+
+    assert_true(poll_move_priority_queue(queue, &result));
+    assert_sint_equals(0, memcmp(&result.state, &states[MOVES - 1u], sizeof(CubeState)));
+
+    double last = result.cost;
+    for (size_t i = 1; i < MOVES; ++i) {
+        assert_true(poll_move_priority_queue(queue, &result));
+        assert_true(result.cost >= last);
+        assert_sint_equals(0, compare_state_keys(result.key, cubestate_key(&result.state)));
+        last = result.cost;
+    }
+
+    assert_false(poll_move_priority_queue(queue, &result));
+
+    assert(free_move_priority_queue(queue));
+}
+
+static void test_trace_moves(void) {
+    MoveTrail *trail = new_move_trail(1);
+    Movement solution[MAXIMUM_MOVEMENTS];
+    PathLink link = START_LINK;
+    uint32_t parent = NO_PARENT;
+
+    assert(trail);
+
+    for (size_t move = 0; move < 3; ++move) {
+        link = (PathLink) { .parent = parent, .depth = link.depth + 1, .move = movement_from_index(move * 4) };
+        assert_true(add_to_move_trail(trail, link, &parent));
+    }
+    link = (PathLink) { .parent = parent, .depth = link.depth + 1, .move = movement_from_index(17) };
+
+    assert_sint_equals(4, trace_moves(trail, link, solution));
+    assert_uint_equals(0u, movement_index(solution[0]));
+    assert_uint_equals(4u, movement_index(solution[1]));
+    assert_uint_equals(8u, movement_index(solution[2]));
+    assert_uint_equals(17u, movement_index(solution[3]));
+
+    assert_sint_equals(0, trace_moves(trail, START_LINK, solution));
+
+    assert(free_move_trail(trail));
+}
+
+static void test_bucket_queue_order(void) {
+    MoveBucketQueue *buckets = new_move_bucket_queue(1);
+    MoveQueueNode result;
+    PathLink link = START_LINK;
+
+    assert(buckets);
+
+    // Costs above the initial buckets make the queue grow.
+    link.depth = 1;
+    assert_true(add_to_move_bucket_queue(buckets, &TEST_STATE, link, 7));
+    link.depth = 2;
+    assert_true(add_to_move_bucket_queue(buckets, &TEST_STATE, link, 5));
+    link.depth = 4;
+    assert_true(add_to_move_bucket_queue(buckets, &TEST_STATE, link, 5));
+    link.depth = 3;
+    assert_true(add_to_move_bucket_queue(buckets, &TEST_STATE, link, 5));
+    assert_uint_equals(4u, buckets->count);
+
+    // Lowest cost first, then deepest.
+    assert_true(poll_move_bucket_queue(buckets, &result));
+    assert_uint_equals(5u, result.cost);
+    assert_uint_equals(4u, result.link.depth);
+
+    // Lower costs added while polling come out next.
+    link.depth = 1;
+    assert_true(add_to_move_bucket_queue(buckets, &TEST_STATE, link, 2));
+
+    const unsigned int costs[4] = { 2u, 5u, 5u, 7u };
+    const unsigned int depths[4] = { 1u, 3u, 2u, 1u };
+    for (size_t i = 0; i < 4; ++i) {
+        assert_true(poll_move_bucket_queue(buckets, &result));
+        assert_uint_equals(costs[i], result.cost);
+        assert_uint_equals(depths[i], result.link.depth);
+        assert_sint_equals(0, memcmp(&result.state, &TEST_STATE, sizeof(CubeState)));
+    }
+
+    assert_false(poll_move_bucket_queue(buckets, &result));
+    assert_sint_equals(MQ_UNDERFLOW, buckets->error);
+
+    assert(free_move_bucket_queue(buckets));
+}
+
+static const Test TESTS[6] = {
     { .test = test_add_to_queue, .name = "Adding to queue preserves all items" },
     { .test = test_poll_from_queue, .name = "Polling queue pulls the lowest heuristics first" },
-    { .test = test_queue_underflow, .name = "Queue underflow is handled correctly" }
+    { .test = test_queue_underflow, .name = "Queue underflow is handled correctly" },
+    { .test = test_distinct_states_polled_in_order, .name = "Distinct states are polled in cost order" },
+    { .test = test_trace_moves, .name = "Move trail rebuilds the movements taken to reach a state" },
+    { .test = test_bucket_queue_order, .name = "Bucket queue polls the lowest cost first, then the deepest" }
 };
 
 int main(void) {
@@ -1,8 +1,14 @@
 #include "../../../testsuite/testsuite.h"
 #include "../cubestate.h"
+#include "../hda_star.h"
+#include "../heuristic.h"
 #include "../movequeue.h"
 #include "../solver.h"
 #include "../ida_star.h"
+#include "../parallel_ida.h"
+#include "../patterndb.h"
+#include "../twophase.h"
+#include "../weighted_star.h"
 
 #include <assert.h>
 #include <stddef.h>
@@ -13,6 +19,34 @@
 
 static CubeState *start;
 
+// Small pattern databases of four corners or four edges, quick to build for the searches using them.
+static const Pattern TEST_PATTERNS[4] = {
+    { .corners = 0x0fu, .edges = 0x000u },
+    { .corners = 0xf0u, .edges = 0x000u },
+    { .corners = 0x00u, .edges = 0x00fu },
+    { .corners = 0x00u, .edges = 0x0f0u }
+};
+
+// Scramble whose prefixes the searches are tested on.
+static const size_t TEST_SCRAMBLE[12] = { 12, 1, 7, 14, 3, 17, 8, 0, 10, 5, 15, 4 };
+
+// Set start to a solved cube turned by the first count movements of TEST_SCRAMBLE.
+static void scramble_start(size_t count) {
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    for (size_t n = 0; n < count; n++) {
+        *start = apply_movement(start, movement_from_index(TEST_SCRAMBLE[n]));
+    }
+}
+
+// Check that applying a solution's movements to cube solves it.
+static void assert_solves(const CubeState *cube, int move_count, const Movement *solution) {
+    CubeState state = *cube;
+    for (int move = 0; move < move_count; move++) {
+        state = apply_movement(&state, solution[move]);
+    }
+    assert_true(solved(&state));
+}
+
 static void test_solver_solved_already(void) {
     // not 0 as it should have to change for the test to pass.
     int move_count = 5;
@@ -20,7 +54,7 @@ static void test_solver_solved_already(void) {
 
     memcpy(start->data, &(EXAMPLE_SOLVED_STATE.data), sizeof(FaceData));
 
-    assert_true(solve(start, &move_count, solution));
+    assert_sint_equals(SOLVE_FOUND, solve(start, NULL, &move_count, solution));
 
     for (int move = 0; move < move_count; move++) {
         printf("direction: %u, face: %u\n", solution[move].direction, solution[move].face);
@@ -36,7 +70,7 @@ static void test_solver_one_move(void) {
 
     memcpy(start->data, &EXAMPLE_UNSOLVED_STATE, sizeof(FaceData));
 
-    assert_true(solve(start, &move_count, solution));
+    assert_sint_equals(SOLVE_FOUND, solve(start, NULL, &move_count, solution));
 
     for (int move = 0; move < move_count; move++) {
         printf("direction: %u, face: %u\n", solution[move].direction, solution[move].face);
@@ -73,7 +107,7 @@ static void test_solver_scrambled(void) {
 
         memcpy(start->data, &nMoves, sizeof(FaceData));
 
-        if (solve(start, &move_count, solution)) {
+        if (solve(start, NULL, &move_count, solution) == SOLVE_FOUND) {
             solved_count++;
             fprintf(stderr, "solved\n");
         }
@@ -111,10 +145,10 @@ static void test_k_solve_scrambled(void) {
 
         memcpy(start->data, &nMoves, sizeof(FaceData));
 
-        g1_midpoint = k_solve(start, &move_count, solution);
+        k_solve(start, NULL, &move_count, solution, &g1_midpoint);
         fprintf(stderr, "solved to g1");
         move_count = 0;
-        if (g1_solve(&g1_midpoint, &move_count, solution)) {
+        if (g1_solve(&g1_midpoint, NULL, &move_count, solution) == SOLVE_FOUND) {
             solved_count++;
             fprintf(stderr, "solved\n");
         }
@@ -131,11 +165,618 @@ static void test_k_solve_scrambled(void) {
     fprintf(stderr, "solved this many out of 5: %d\n", solved_count);
 }
 
-static const Test TESTS[4] = {
+static void test_ida_solve_short_scramble(void) {
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+    const size_t scramble[4] = { 0, 4, 10, 17 };
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    for (size_t n = 0; n < 4; n++) {
+        *start = apply_movement(start, movement_from_index(scramble[n]));
+    }
+
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, NULL, NULL, &move_count, solution));
+    assert_true(move_count <= MAXIMUM_MOVEMENTS);
+
+    assert_solves(start, move_count, solution);
+}
+
+static void test_twophase_coordinates(void) {
+    CubieState cubies = SOLVED_CUBIES;
+
+    assert_uint_equals(0u, twist_coordinate(&cubies));
+    assert_uint_equals(0u, flip_coordinate(&cubies));
+    assert_uint_equals(0u, slice_coordinate(&cubies));
+    assert_uint_equals(0u, corner_permutation_coordinate(&cubies));
+    assert_uint_equals(0u, edge_permutation_coordinate(&cubies));
+    assert_uint_equals(0u, slice_permutation_coordinate(&cubies));
+
+    // Phase 2 movements never leave G1.
+    for (size_t move = 0; move < PHASE_2_MOVES; move++) {
+        cubies = apply_cubie_movement(&cubies, movement_from_index(PHASE_2_MOVEMENTS[move]));
+    }
+    assert_uint_equals(0u, twist_coordinate(&cubies));
+    assert_uint_equals(0u, flip_coordinate(&cubies));
+    assert_uint_equals(0u, slice_coordinate(&cubies));
+    assert_uint_not_equals(0u, corner_permutation_coordinate(&cubies));
+
+    // A quarter turn of a side face twists corners and moves middle layer edges out of their layer.
+    cubies = apply_cubie_movement(&SOLVED_CUBIES, (Movement) { .face = FRONT, .direction = CW });
+    assert_uint_not_equals(0u, twist_coordinate(&cubies));
+    assert_uint_not_equals(0u, flip_coordinate(&cubies));
+    assert_uint_not_equals(0u, slice_coordinate(&cubies));
+}
+
+static void test_twophase_solve_scrambled(void) {
+    const size_t SCRAMBLES[2][25] = {
+        { 7, 2, 7, 3, 0, 0, 11, 9, 4, 15, 2, 3, 7, 1, 17, 3, 10, 9, 2, 1, 7, 11, 0, 17, 1 },
+        { 16, 10, 1, 0, 9, 9, 9, 12, 13, 6, 13, 17, 0, 3, 6, 10, 2, 6, 15, 7, 11, 16, 5, 5, 16 }
+    };
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+
+    assert_true(init_twophase_tables());
+
+    for (size_t i = 0; i < 2; i++) {
+        memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+        for (size_t n = 0; n < 25; n++) {
+            *start = apply_movement(start, movement_from_index(SCRAMBLES[i][n]));
+        }
+
+        assert_true(twophase_solve(start, &move_count, solution));
+        assert_true(move_count <= MAXIMUM_MOVEMENTS);
+
+        assert_solves(start, move_count, solution);
+    }
+
+    free_twophase_tables();
+}
+
+static void test_pattern_database_distances(void) {
+    const Pattern TOP_CORNERS = { .corners = 0x0fu, .edges = 0x000u };
+    PatternDatabase *database = build_pattern_database(TOP_CORNERS);
+    assert_true(database != NULL);
+
+    assert_uint_equals(8u * 7u * 6u * 5u * 81u, database->size);
+    assert_uint_equals(0u, pattern_distance(database, &SOLVED_CUBIES));
+
+    // Placements of a partial set of corners are all reachable.
+    for (size_t index = 0; index < database->size; index++) {
+        assert_uint_not_equals(UNREACHED_PATTERN, database->entries[index]);
+    }
+
+    CubieState cubies = apply_cubie_movement(&SOLVED_CUBIES, (Movement) { .face = RIGHT, .direction = CW });
+    assert_uint_equals(1u, pattern_distance(database, &cubies));
+    cubies = apply_cubie_movement(&cubies, (Movement) { .face = TOP, .direction = DOUBLE });
+    assert_uint_equals(2u, pattern_distance(database, &cubies));
+
+    // Bottom layer movements leave the top corners alone.
+    cubies = apply_cubie_movement(&SOLVED_CUBIES, (Movement) { .face = BOTTOM, .direction = CCW });
+    assert_uint_equals(0u, pattern_distance(database, &cubies));
+
+    free_pattern_database(database);
+}
+
+static void test_pattern_database_file(void) {
+    const Pattern TOP_EDGES = { .corners = 0x00u, .edges = 0x00fu };
+    const char *path = "testsolver_pattern.pdb";
+    PatternDatabase *built = build_pattern_database(TOP_EDGES);
+    assert_true(built != NULL);
+
+    assert_true(save_pattern_database(built, path));
+    PatternDatabase *loaded = load_pattern_database(path, TOP_EDGES);
+    assert_true(loaded != NULL);
+
+    assert_uint_equals(TOP_EDGES.edges, loaded->pattern.edges);
+    assert_uint_equals(built->size, loaded->size);
+    assert_true(memcmp(built->entries, loaded->entries, built->size) == 0);
+    free_pattern_database(loaded);
+
+    // A sound file for other cubies would give the wrong distances.
+    const Pattern BOTTOM_EDGES = { .corners = 0x00u, .edges = 0x0f0u };
+    assert_true(load_pattern_database(path, BOTTOM_EDGES) == NULL);
+
+    // A single changed entry fails the checksum.
+    FILE *file = fopen(path, "r+b");
+    assert_true(file != NULL);
+    fseek(file, sizeof(PatternFileHeader) + built->size / 2, SEEK_SET);
+    fputc(built->entries[built->size / 2] + 1, file);
+    fclose(file);
+    assert_true(load_pattern_database(path, TOP_EDGES) == NULL);
+
+    // Packed tables keep their encoding.
+    PatternDatabase *packed = pack_pattern_database(built, MOD3_ENCODING);
+    assert_true(packed != NULL);
+    assert_true(save_pattern_database(packed, path));
+    loaded = load_pattern_database(path, TOP_EDGES);
+    assert_true(loaded != NULL);
+    assert_uint_equals(MOD3_ENCODING, loaded->encoding);
+    assert_uint_equals(packed->bytes, loaded->bytes);
+    assert_true(memcmp(packed->entries, loaded->entries, packed->bytes) == 0);
+    free_pattern_database(loaded);
+    free_pattern_database(packed);
+
+    remove(path);
+    assert_true(load_pattern_database(path, TOP_EDGES) == NULL);
+
+    free_pattern_database(built);
+}
+
+static void test_pattern_database_encodings(void) {
+    const Pattern TOP_CORNERS = { .corners = 0x0fu, .edges = 0x000u };
+    PatternDatabase *bytes = build_pattern_database(TOP_CORNERS);
+    assert_true(bytes != NULL);
+    PatternDatabase *nibbles = pack_pattern_database(bytes, NIBBLE_ENCODING);
+    assert_true(nibbles != NULL);
+    PatternDatabase *mod3 = pack_pattern_database(bytes, MOD3_ENCODING);
+    assert_true(mod3 != NULL);
+
+    assert_uint_equals((bytes->size + 1) / 2, nibbles->bytes);
+    assert_uint_equals((bytes->size + 3) / 4, mod3->bytes);
+
+    // Follow a walk away from solved, decoding every table at each step.
+    CubieState cubies = SOLVED_CUBIES;
+    uint8_t parent = 0u;
+    srand(12345);
+    for (int step = 0; step < 40; step++) {
+        cubies = apply_cubie_movement(&cubies, movement_from_index(rand() % MOVES));
+        uint8_t distance = pattern_distance(bytes, &cubies);
+
+        assert_uint_equals(distance, pattern_distance(nibbles, &cubies));
+        assert_uint_equals(distance, pattern_distance(mod3, &cubies));
+        assert_uint_equals(distance, pattern_distance_from(mod3, &cubies, parent));
+        parent = distance;
+    }
+
+    free_pattern_database(mod3);
+    free_pattern_database(nibbles);
+    free_pattern_database(bytes);
+}
+
+static void test_pattern_database_symmetry(void) {
+    const Pattern SLICE_EDGES = { .corners = 0x00u, .edges = 0xf00u };
+    const char *path = "testsolver_symmetric.pdb";
+    PatternDatabase *full = build_pattern_database(SLICE_EDGES);
+    assert_true(full != NULL);
+
+    // The top and bottom edges are not kept together by the symmetries that tip the cube over.
+    assert_true(pattern_symmetric(SLICE_EDGES, UD_SYMMETRIES));
+    assert_false(pattern_symmetric(FIRST_EDGE_PATTERN, UD_SYMMETRIES));
+    assert_true(reduce_pattern_database(full, SYMMETRIES) == NULL);
+
+    PatternDatabase *reduced = reduce_pattern_database(full, UD_SYMMETRIES);
+    assert_true(reduced != NULL);
+    assert_true(reduced->size * UD_SYMMETRIES / 2 < full->size);
+    assert_true(reduced->size * UD_SYMMETRIES >= full->size);
+    assert_uint_equals(0u, pattern_distance(reduced, &SOLVED_CUBIES));
+
+    assert_true(save_pattern_database(reduced, path));
+    PatternDatabase *loaded = load_pattern_database(path, SLICE_EDGES);
+    assert_true(loaded != NULL);
+    assert_sint_equals(UD_SYMMETRIES, loaded->symmetries);
+    assert_uint_equals(reduced->size, loaded->size);
+    remove(path);
+
+    PatternDatabase *mod3 = pack_pattern_database(reduced, MOD3_ENCODING);
+    assert_true(mod3 != NULL);
+
+    // Every reduced table agrees with the full one along a walk away from solved.
+    CubieState cubies = SOLVED_CUBIES;
+    uint8_t parent = 0u;
+    srand(54321);
+    for (int step = 0; step < 40; step++) {
+        cubies = apply_cubie_movement(&cubies, movement_from_index(rand() % MOVES));
+        uint8_t distance = pattern_distance(full, &cubies);
+
+        assert_uint_equals(distance, pattern_distance(reduced, &cubies));
+        assert_uint_equals(distance, pattern_distance(loaded, &cubies));
+        assert_uint_equals(distance, pattern_distance(mod3, &cubies));
+        assert_uint_equals(distance, pattern_distance_from(mod3, &cubies, parent));
+        parent = distance;
+    }
+
+    free_pattern_database(mod3);
+    free_pattern_database(loaded);
+    free_pattern_database(reduced);
+    free_pattern_database(full);
+}
+
+static void test_ida_solve_optimal(void) {
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+
+    PatternHeuristic *patterns = new_pattern_heuristic(TEST_PATTERNS, 4, BYTE_ENCODING);
+    assert_true(patterns != NULL);
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &move_count, solution));
+    assert_sint_equals(0, move_count);
+
+    // R U has no shorter solution than undoing both turns.
+    *start = apply_movement(start, (Movement) { .face = RIGHT, .direction = CW });
+    *start = apply_movement(start, (Movement) { .face = TOP, .direction = CW });
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &move_count, solution));
+    assert_sint_equals(2, move_count);
+
+    scramble_start(6);
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &move_count, solution));
+    assert_true(move_count <= 6);
+
+    // Two bit tables give the same estimates, so the same shortest length.
+    int byte_move_count = move_count;
+    free_pattern_heuristic(patterns);
+    patterns = new_pattern_heuristic(TEST_PATTERNS, 4, MOD3_ENCODING);
+    assert_true(patterns != NULL);
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &move_count, solution));
+    assert_sint_equals(byte_move_count, move_count);
+
+    assert_solves(start, move_count, solution);
+
+    free_pattern_heuristic(patterns);
+}
+
+static void test_parallel_ida_solve(void) {
+    int move_count = -1, serial_move_count = -1;
+    Movement solution[MAXIMUM_MOVEMENTS];
+
+    PatternHeuristic *patterns = new_pattern_heuristic(TEST_PATTERNS, 4, BYTE_ENCODING);
+    assert_true(patterns != NULL);
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    assert_true(parallel_ida_solve(start, patterns, 4, &move_count, solution));
+    assert_sint_equals(0, move_count);
+
+    // Solutions shorter than a task's prefix are found while splitting the tree.
+    *start = apply_movement(start, (Movement) { .face = RIGHT, .direction = CW });
+    *start = apply_movement(start, (Movement) { .face = TOP, .direction = CW });
+    assert_true(parallel_ida_solve(start, patterns, 4, &move_count, solution));
+    assert_sint_equals(2, move_count);
+
+    scramble_start(7);
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &serial_move_count, solution));
+
+    // Any number of workers finds a solution as short as the serial search.
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        assert_true(parallel_ida_solve(start, patterns, threads, &move_count, solution));
+        assert_sint_equals(serial_move_count, move_count);
+
+        assert_solves(start, move_count, solution);
+    }
+
+    free_pattern_heuristic(patterns);
+}
+
+static void test_hda_solve(void) {
+    int move_count = 0, serial_move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+    CubeState state;
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    assert_true(hda_solve(start, &GREEDY_HEURISTIC, 4, &move_count, solution));
+    assert_sint_equals(0, move_count);
+
+    scramble_start(6);
+    assert_sint_equals(SOLVE_FOUND, solve(start, NULL, &serial_move_count, solution));
+
+    // Every thread count runs until no thread could find a shorter solution.
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        assert_true(hda_solve(start, &GREEDY_HEURISTIC, threads, &move_count, solution));
+        assert_true(move_count <= serial_move_count);
+
+        assert_solves(start, move_count, solution);
+    }
+
+    // The Kociemba stages, each through states owned by different threads.
+    CubeState g1_midpoint = hda_k_solve(start, &GREEDY_HEURISTIC, 4, &move_count, solution);
+    assert_true(within_g1(&g1_midpoint));
+    memcpy(&state, start, sizeof(CubeState));
+    for (int move = 0; move < move_count; move++) {
+        state = apply_movement(&state, solution[move]);
+    }
+    assert_true(memcmp(&state, &g1_midpoint, sizeof(CubeState)) == 0);
+
+    assert_true(hda_g1_solve(&g1_midpoint, &GREEDY_HEURISTIC, 4, &move_count, solution));
+    for (int move = 0; move < move_count; move++) {
+        assert_true(solution[move].face == TOP || solution[move].face == BOTTOM
+                    || solution[move].direction == DOUBLE);
+        g1_midpoint = apply_movement(&g1_midpoint, solution[move]);
+    }
+    assert_true(solved(&g1_midpoint));
+}
+
+static void test_hda_solve_optimal(void) {
+    int shortest = 0;
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+
+    PatternHeuristic *patterns = new_pattern_heuristic(TEST_PATTERNS, 4, BYTE_ENCODING);
+    assert_true(patterns != NULL);
+    Heuristic admissible = patterns_heuristic(patterns);
+
+    scramble_start(7);
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &shortest, solution));
+
+    // With an admissible heuristic, every thread count keeps going until the incumbent is a shortest solution.
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        assert_true(hda_solve(start, &admissible, threads, &move_count, solution));
+        assert_sint_equals(shortest, move_count);
+        assert_solves(start, move_count, solution);
+    }
+
+    free_pattern_heuristic(patterns);
+}
+
+/*
+ * Checks each solution solve_with_budget reports, counting them in context.
+ */
+typedef struct {
+    int count;
+    int last_length;
+    int stop_after;
+} BudgetReports;
+
+static bool check_budget_solution(int move_count, const Movement *solution, void *context) {
+    BudgetReports *reports = (BudgetReports *) context;
+
+    assert_solves(start, move_count, solution);
+    assert_true(reports->count == 0 || move_count < reports->last_length);
+
+    reports->count++;
+    reports->last_length = move_count;
+
+    return reports->count != reports->stop_after;
+}
+
+static void test_solve_with_budget(void) {
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+    struct timespec began, deadline, ended;
+
+    // With no deadline, the search runs out of lengths at a shortest solution.
+    scramble_start(7);
+    BudgetReports reports = { .count = 0, .stop_after = 0 };
+    assert_true(solve_with_budget(start, NULL, check_budget_solution, &reports, &move_count, solution));
+    assert_true(reports.count > 1);
+    assert_sint_equals(reports.last_length, move_count);
+    assert_true(move_count <= 7);
+
+    // The callback can settle for the first solution.
+    reports = (BudgetReports) { .count = 0, .stop_after = 1 };
+    assert_true(solve_with_budget(start, NULL, check_budget_solution, &reports, &move_count, solution));
+    assert_sint_equals(1, reports.count);
+    assert_sint_equals(reports.last_length, move_count);
+
+    // A long scramble is still improving at the deadline, and stops close to it.
+    srand(3u);
+    for (size_t n = 0; n < 30; n++) {
+        *start = apply_movement(start, movement_from_index(rand() % MOVES));
+    }
+    assert_true(init_twophase_tables());
+    clock_gettime(CLOCK_MONOTONIC, &began);
+    deadline = began;
+    deadline.tv_sec += 1;
+    reports = (BudgetReports) { .count = 0, .stop_after = 0 };
+    assert_true(solve_with_budget(start, &deadline, check_budget_solution, &reports, &move_count, solution));
+    clock_gettime(CLOCK_MONOTONIC, &ended);
+
+    assert_true(reports.count >= 1);
+    assert_sint_equals(reports.last_length, move_count);
+    assert_true(ended.tv_sec - began.tv_sec < 3);
+}
+
+static void test_solve_limits(void) {
+    const size_t g1_scramble[6] = { 0, 13, 16, 4, 7, 10 };
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+    CubeState g1_state;
+    struct timespec past = { .tv_sec = 0, .tv_nsec = 0 };
+    int cancel = 1;
+
+    scramble_start(10);
+
+    SolveLimits limits = { .max_nodes = 100u };
+    assert_sint_equals(SOLVE_LIMIT_HIT, solve(start, &limits, &move_count, solution));
+    assert_sint_equals(SOLVE_LIMIT_HIT, k_solve(start, &(SolveLimits) { .max_nodes = 1u },
+                                                &move_count, solution, &g1_state));
+    assert_true(memcmp(&g1_state, start, sizeof(CubeState)) == 0);
+
+    limits = (SolveLimits) { .max_bytes = 4096u };
+    assert_sint_equals(SOLVE_LIMIT_HIT, solve(start, &limits, &move_count, solution));
+    assert_sint_equals(SOLVE_LIMIT_HIT, ida_solve(start, NULL, &limits, &move_count, solution));
+
+    limits = (SolveLimits) { .deadline = &past };
+    assert_sint_equals(SOLVE_LIMIT_HIT, solve(start, &limits, &move_count, solution));
+    assert_sint_equals(SOLVE_LIMIT_HIT, ida_solve(start, NULL, &limits, &move_count, solution));
+
+    limits = (SolveLimits) { .cancel = &cancel };
+    assert_sint_equals(SOLVE_CANCELLED, solve(start, &limits, &move_count, solution));
+    assert_sint_equals(SOLVE_CANCELLED, k_solve(start, &limits, &move_count, solution, &g1_state));
+    assert_sint_equals(SOLVE_CANCELLED, ida_solve(start, NULL, &limits, &move_count, solution));
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    for (size_t n = 0; n < 6; n++) {
+        *start = apply_movement(start, movement_from_index(g1_scramble[n]));
+    }
+    assert_sint_equals(SOLVE_CANCELLED, g1_solve(start, &limits, &move_count, solution));
+
+    // It queues over 600 states while expanding under 100, so capping the memory caps the queue.
+    limits = (SolveLimits) { .max_bytes = 400 * sizeof(MoveQueueNode) };
+    assert_sint_equals(SOLVE_LIMIT_HIT, g1_solve(start, &limits, &move_count, solution));
+
+    // Limits a solve stays within change nothing.
+    limits = (SolveLimits) { .cancel = &cancel };
+    cancel = 0;
+    limits.max_nodes = 1000000u;
+    assert_sint_equals(SOLVE_FOUND, g1_solve(start, &limits, &move_count, solution));
+    assert_true(move_count <= 6);
+}
+
+static void test_heuristic_composition(void) {
+    const size_t scramble[4] = { 0, 4, 10, 17 };
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+    Heuristic composed;
+
+    assert_false(parse_heuristic("", NULL, &composed));
+    assert_false(parse_heuristic("max:spot,bogus", NULL, &composed));
+    assert_false(parse_heuristic("pattern", NULL, &composed));
+
+    assert_true(parse_heuristic("sum:misplaced,kociemba", NULL, &composed));
+    assert_sint_equals(SUM_RULE, composed.rule);
+    assert_false(heuristic_admissible(&composed));
+    Heuristic misplaced_and_kociemba = composed;
+
+    // Sums of admissible components can overestimate, but their largest cannot.
+    assert_true(parse_heuristic("sum:spot", NULL, &composed));
+    assert_true(heuristic_admissible(&composed));
+    composed = (Heuristic) { .components = 1u << SPOT_COLOUR_COMPONENT | 1u << PATTERN_COMPONENT, .rule = MAX_RULE };
+    assert_true(heuristic_admissible(&composed));
+    composed.rule = SUM_RULE;
+    assert_false(heuristic_admissible(&composed));
+    assert_true(parse_heuristic("max:spot", NULL, &composed));
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    assert_sint_equals(0, heuristic_estimate(&misplaced_and_kociemba, start));
+    assert_sint_equals(0, heuristic_estimate(&composed, start));
+    *start = apply_movement(start, movement_from_index(scramble[0]));
+    assert_sint_equals(1, heuristic_estimate(&composed, start));
+    assert_sint_equals(heuristic(start), heuristic_estimate(&GREEDY_HEURISTIC, start));
+
+    for (size_t n = 1; n < 4; n++) {
+        *start = apply_movement(start, movement_from_index(scramble[n]));
+    }
+    assert_true(heuristic_estimate(&composed, start) <= 4);
+
+    // An admissible heuristic finds a shortest solution.
+    assert_sint_equals(SOLVE_FOUND, ida_solve_with(start, &composed, NULL, &move_count, solution));
+    assert_sint_equals(4, move_count);
+    assert_sint_equals(SOLVE_FOUND, ida_solve_with(start, &misplaced_and_kociemba, NULL, &move_count, solution));
+    assert_solves(start, move_count, solution);
+}
+
+static void test_heuristic_update(void) {
+    HeuristicTally tally;
+    HeuristicTally updated;
+    HeuristicTally afresh;
+    CubeState child;
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    for (size_t n = 0; n <= 12; n++) {
+        for (HeuristicComponent component = 0; component < PATTERN_COMPONENT; component++) {
+            Heuristic single = { .components = 1u << component, .rule = MAX_RULE };
+            heuristic_tally(&single, start, &tally);
+
+            for (size_t move = 0; move < MOVES; move++) {
+                Movement movement = movement_from_index(move);
+                child = apply_movement(start, movement);
+                int h = heuristic_update(&single, &tally, movement, &child, &updated);
+                assert_sint_equals(heuristic_tally(&single, &child, &afresh), h);
+                assert_true(memcmp(&updated, &afresh, sizeof(HeuristicTally)) == 0);
+            }
+        }
+
+        if (n < 12) {
+            *start = apply_movement(start, movement_from_index(TEST_SCRAMBLE[n]));
+        }
+    }
+}
+
+static void test_bounded_suboptimal_solve(void) {
+    int shortest = 0;
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+
+    PatternHeuristic *patterns = new_pattern_heuristic(TEST_PATTERNS, 4, BYTE_ENCODING);
+    assert_true(patterns != NULL);
+    Heuristic bounding = patterns_heuristic(patterns);
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    assert_sint_equals(SOLVE_FOUND, weighted_solve(start, &bounding, 1.2, NULL, &move_count, solution));
+    assert_sint_equals(0, move_count);
+    assert_sint_equals(SOLVE_FOUND, focal_solve(start, &bounding, NULL, 1.2, NULL, &move_count, solution));
+    assert_sint_equals(0, move_count);
+
+    scramble_start(7);
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &shortest, solution));
+
+    // Unweighted, both are A* and find a shortest solution.
+    assert_sint_equals(SOLVE_FOUND, weighted_solve(start, &bounding, 1.0, NULL, &move_count, solution));
+    assert_sint_equals(shortest, move_count);
+    assert_sint_equals(SOLVE_FOUND, focal_solve(start, &bounding, NULL, 1.0, NULL, &move_count, solution));
+    assert_sint_equals(shortest, move_count);
+
+    // Weights below 1 are taken as 1, so the bound still holds.
+    assert_sint_equals(SOLVE_FOUND, weighted_solve(start, &bounding, 0.5, NULL, &move_count, solution));
+    assert_sint_equals(shortest, move_count);
+
+    // Weighted, they stay within the bound, even with a greedy guide.
+    assert_sint_equals(SOLVE_FOUND, weighted_solve(start, &bounding, 1.2, NULL, &move_count, solution));
+    assert_true(move_count <= 1.2 * shortest);
+    assert_sint_equals(SOLVE_FOUND, focal_solve(start, &bounding, &GREEDY_HEURISTIC, 1.2, NULL,
+                                                &move_count, solution));
+    assert_true(move_count <= 1.2 * shortest);
+
+    assert_solves(start, move_count, solution);
+
+    SolveLimits limits = { .max_nodes = 1u };
+    assert_sint_equals(SOLVE_LIMIT_HIT, weighted_solve(start, &bounding, 1.2, &limits, &move_count, solution));
+    assert_sint_equals(SOLVE_LIMIT_HIT, focal_solve(start, &bounding, NULL, 1.2, &limits, &move_count, solution));
+
+    free_pattern_heuristic(patterns);
+}
+
+static void test_partial_expansion_solve(void) {
+    int shortest = 0;
+    int move_count = 0;
+    Movement solution[MAXIMUM_MOVEMENTS];
+
+    PatternHeuristic *patterns = new_pattern_heuristic(TEST_PATTERNS, 4, BYTE_ENCODING);
+    assert_true(patterns != NULL);
+    Heuristic admissible = patterns_heuristic(patterns);
+
+    memcpy(start->data, &EXAMPLE_SOLVED_STATE, sizeof(FaceData));
+    assert_sint_equals(SOLVE_FOUND, partial_expansion_solve(start, &GREEDY_HEURISTIC, NULL, &move_count, solution));
+    assert_sint_equals(0, move_count);
+
+    // With an admissible heuristic, queuing children a cost at a time still finds a shortest solution.
+    scramble_start(7);
+    assert_sint_equals(SOLVE_FOUND, ida_solve(start, patterns, NULL, &shortest, solution));
+    assert_sint_equals(SOLVE_FOUND, partial_expansion_solve(start, &admissible, NULL, &move_count, solution));
+    assert_sint_equals(shortest, move_count);
+
+    scramble_start(10);
+    assert_sint_equals(SOLVE_FOUND, partial_expansion_solve(start, &GREEDY_HEURISTIC, NULL, &move_count, solution));
+    assert_solves(start, move_count, solution);
+
+    SolveLimits limits = { .max_nodes = 1u };
+    assert_sint_equals(SOLVE_LIMIT_HIT, partial_expansion_solve(start, &GREEDY_HEURISTIC, &limits,
+                                                                &move_count, solution));
+
+    free_pattern_heuristic(patterns);
+}
+
+static const Test TESTS[21] = {
     { .test = test_solver_solved_already, .name = "Solver runs without error and detects solved state" },
     { .test = test_solver_one_move, .name = "Solver updates output fields and can solve single move puzzle"},
     { .test = test_solver_scrambled, .name = "Solve an arbitrarily scrambled cube"},
-    { .test = test_k_solve_scrambled, .name = "Solve cubes useing kociemba method"}
+    { .test = test_k_solve_scrambled, .name = "Solve cubes useing kociemba method"},
+    { .test = test_ida_solve_short_scramble, .name = "IDA* solves a short scramble"},
+    { .test = test_twophase_coordinates, .name = "Two-phase coordinates are zero exactly where each phase ends"},
+    { .test = test_twophase_solve_scrambled, .name = "Two-phase solves random scrambles within the maximum movements"},
+    { .test = test_pattern_database_distances, .name = "Pattern databases hold exact distances for their cubies"},
+    { .test = test_pattern_database_file, .name = "Pattern databases survive a round trip through a file"},
+    { .test = test_pattern_database_encodings, .name = "Nibble and mod 3 tables decode to the same distances"},
+    { .test = test_pattern_database_symmetry, .name = "Symmetry reduced tables give the same distances"},
+    { .test = test_ida_solve_optimal, .name = "IDA* with pattern databases finds shortest solutions"},
+    { .test = test_parallel_ida_solve, .name = "Parallel IDA* finds shortest solutions on any number of threads"},
+    { .test = test_hda_solve, .name = "Hash distributed A* solves on any number of threads"},
+    { .test = test_hda_solve_optimal, .name = "Hash distributed A* with pattern databases finds shortest solutions"},
+    { .test = test_solve_with_budget, .name = "Anytime solving reports ever shorter solutions until its deadline"},
+    { .test = test_solve_limits, .name = "Every solver stops at its limits and reports why"},
+    { .test = test_heuristic_composition, .name = "Heuristics compose from components and report admissibility"},
+    { .test = test_heuristic_update, .name = "Heuristic updates across a movement match estimating afresh"},
+    { .test = test_bounded_suboptimal_solve, .name = "Weighted and focal A* stay within their bound of a shortest solution"},
+    { .test = test_partial_expansion_solve, .name = "Partial expansion A* queues children a cost at a time and still solves"}
 };
 
 int main(void) {
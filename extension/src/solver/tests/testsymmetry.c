@@ -0,0 +1,90 @@
+#include "../../../testsuite/testsuite.h"
+#include "../cubestate.h"
+#include "../symmetry.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Movements in the scramble the tests conjugate.
+#define SCRAMBLE_LENGTH 30
+
+static CubieState scrambled(unsigned int seed) {
+    CubieState cubies = SOLVED_CUBIES;
+    srand(seed);
+    for (int i = 0; i < SCRAMBLE_LENGTH; ++i) {
+        cubies = apply_cubie_movement(&cubies, movement_from_index(rand() % MOVES));
+    }
+    return cubies;
+}
+
+static bool cubies_equal(const CubieState *a, const CubieState *b) {
+    return memcmp(a, b, sizeof(CubieState)) == 0;
+}
+
+static void test_inverses(void) {
+    CubieState cubies = scrambled(1u);
+
+    assert_true(cubies_solved(symmetry_cubies(0)));
+
+    for (int s = 0; s < SYMMETRIES; ++s) {
+        CubieState solved = conjugate_cubies(&SOLVED_CUBIES, s);
+        assert_true(cubies_solved(&solved));
+
+        // Conjugating back by the inverse restores the cube.
+        CubieState conjugated = conjugate_cubies(&cubies, s);
+        CubieState restored = conjugate_cubies(&conjugated, inverse_symmetry(s));
+        assert_true(cubies_equal(&cubies, &restored));
+
+        for (int t = 0; t < s; ++t) {
+            assert_false(cubies_equal(symmetry_cubies(s), symmetry_cubies(t)));
+        }
+    }
+}
+
+static void test_conjugate_moves(void) {
+    CubieState cubies = scrambled(2u);
+
+    for (int s = 0; s < SYMMETRIES; ++s) {
+        uint32_t images = 0u;
+        CubieState conjugated = conjugate_cubies(&cubies, s);
+
+        for (uint8_t move = 0; move < MOVES; ++move) {
+            CubieState moved = apply_cubie_movement(&cubies, movement_from_index(move));
+            CubieState expected = conjugate_cubies(&moved, s);
+
+            // Some movement of the conjugated cube gives the conjugate of the moved cube.
+            uint8_t image = 0;
+            for (; image < MOVES; ++image) {
+                CubieState actual = apply_cubie_movement(&conjugated, movement_from_index(image));
+                if (cubies_equal(&expected, &actual)) break;
+            }
+            assert_true(image < MOVES);
+            images |= UINT32_C(1) << image;
+
+            // The symmetries which keep the TOP - BOTTOM axis keep TOP and BOTTOM movements on it.
+            Movement movement = movement_from_index(move);
+            if (s < UD_SYMMETRIES && (movement.face == TOP || movement.face == BOTTOM)) {
+                Movement conjugated_movement = movement_from_index(image);
+                assert_true(conjugated_movement.face == TOP || conjugated_movement.face == BOTTOM);
+            }
+        }
+
+        assert_uint_equals(ALL_MOVES, images);
+    }
+}
+
+static const Test TESTS[2] = {
+    { .test = test_inverses, .name = "Each symmetry has an inverse and fixes the solved cube" },
+    { .test = test_conjugate_moves, .name = "Movements conjugate to movements" }
+};
+
+int main(void) {
+    fprintf(stderr, "--- %s ---\n", __FILE__);
+
+    run_tests(TESTS, sizeof(TESTS) / sizeof(Test));
+
+    return 0;
+}
@@ -0,0 +1,618 @@
+#include "twophase.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Number of search nodes between looks at the clock in solve_with_budget.
+#define DEADLINE_INTERVAL 4096u
+
+// Marks a pruning table entry that has not been reached yet.
+#define UNREACHED 0xffu
+
+// The first edge of the middle layer. Edges from here on belong in the middle layer.
+#define FIRST_SLICE_EDGE FRONT_RIGHT
+#define SLICE_EDGES      (EDGES - FIRST_SLICE_EDGE)
+#define LAYER_EDGES      FIRST_SLICE_EDGE
+
+static uint16_t (*twist_moves)[MOVES];
+static uint16_t (*flip_moves)[MOVES];
+static uint16_t (*slice_moves)[MOVES];
+static uint16_t (*corner_permutation_moves)[PHASE_2_MOVES];
+static uint16_t (*edge_permutation_moves)[PHASE_2_MOVES];
+static uint8_t (*slice_permutation_moves)[PHASE_2_MOVES];
+
+static uint8_t *twist_slice_distances;
+static uint8_t *flip_slice_distances;
+static uint8_t *corner_slice_distances;
+static uint8_t *edge_slice_distances;
+
+static bool tables_ready = false;
+// Solves may start from several threads at once. The tables can be freed and built again, or fail to build
+// and be tried again, so they are guarded by a lock rather than built under a once.
+static pthread_mutex_t tables_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int binomial(int n, int k) {
+    if (k < 0 || k > n) {
+        return 0u;
+    }
+
+    unsigned int result = 1u;
+    for (int i = 1; i <= k; ++i) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+static void rotate_left(uint8_t *values, int right) {
+    uint8_t first = values[0];
+    memmove(values, values + 1, right);
+    values[right] = first;
+}
+
+static void rotate_right(uint8_t *values, int right) {
+    uint8_t last = values[right];
+    memmove(values + 1, values, right);
+    values[0] = last;
+}
+
+// Rank a permutation of 0 to n - 1, rotating each largest value into place.
+static uint16_t permutation_rank(uint8_t *values, int n) {
+    uint16_t rank = 0u;
+
+    for (int j = n - 1; j > 0; --j) {
+        int k = 0;
+        while (values[j] != j) {
+            rotate_left(values, j);
+            ++k;
+        }
+        rank = (j + 1) * rank + k;
+    }
+
+    return rank;
+}
+
+// The inverse of permutation_rank.
+static void permutation_unrank(uint16_t rank, uint8_t *values, int n) {
+    for (int j = 0; j < n; ++j) {
+        values[j] = j;
+    }
+
+    for (int j = 0; j < n; ++j) {
+        int k = rank % (j + 1);
+        rank /= j + 1;
+        while (k-- > 0) {
+            rotate_right(values, j);
+        }
+    }
+}
+
+uint16_t twist_coordinate(const CubieState *cubies) {
+    uint16_t twist = 0u;
+    for (int i = 0; i < CORNERS - 1; ++i) {
+        twist = 3u * twist + CornerTwist(cubies->corners[i]);
+    }
+    return twist;
+}
+
+uint16_t flip_coordinate(const CubieState *cubies) {
+    uint16_t flip = 0u;
+    for (int i = 0; i < EDGES - 1; ++i) {
+        flip = 2u * flip + EdgeFlip(cubies->edges[i]);
+    }
+    return flip;
+}
+
+uint16_t slice_coordinate(const CubieState *cubies) {
+    uint16_t slice = 0u;
+    int found = 0;
+
+    for (int j = EDGES - 1; j >= 0; --j) {
+        if (EdgeCubie(cubies->edges[j]) >= FIRST_SLICE_EDGE) {
+            slice += binomial(EDGES - 1 - j, found + 1);
+            ++found;
+        }
+    }
+
+    return slice;
+}
+
+uint16_t corner_permutation_coordinate(const CubieState *cubies) {
+    uint8_t values[CORNERS];
+    for (int i = 0; i < CORNERS; ++i) {
+        values[i] = CornerCubie(cubies->corners[i]);
+    }
+    return permutation_rank(values, CORNERS);
+}
+
+uint16_t edge_permutation_coordinate(const CubieState *cubies) {
+    uint8_t values[LAYER_EDGES];
+    for (int i = 0; i < LAYER_EDGES; ++i) {
+        values[i] = EdgeCubie(cubies->edges[i]);
+    }
+    return permutation_rank(values, LAYER_EDGES);
+}
+
+uint8_t slice_permutation_coordinate(const CubieState *cubies) {
+    uint8_t values[SLICE_EDGES];
+    for (int i = 0; i < SLICE_EDGES; ++i) {
+        values[i] = EdgeCubie(cubies->edges[FIRST_SLICE_EDGE + i]) - FIRST_SLICE_EDGE;
+    }
+    return permutation_rank(values, SLICE_EDGES);
+}
+
+// Setters build a cube with the given coordinate, leaving everything else it does not describe solved.
+
+static void set_twist(CubieState *cubies, uint16_t twist) {
+    int total = 0;
+    for (int i = CORNERS - 2; i >= 0; --i) {
+        cubies->corners[i] = PackCorner(i, twist % 3u);
+        total += twist % 3u;
+        twist /= 3u;
+    }
+    cubies->corners[CORNERS - 1] = PackCorner(CORNERS - 1, (3 - total % 3) % 3);
+}
+
+static void set_flip(CubieState *cubies, uint16_t flip) {
+    int total = 0;
+    for (int i = EDGES - 2; i >= 0; --i) {
+        cubies->edges[i] = PackEdge(i, flip & 1u);
+        total += flip & 1u;
+        flip >>= 1u;
+    }
+    cubies->edges[EDGES - 1] = PackEdge(EDGES - 1, total & 1);
+}
+
+static void set_slice(CubieState *cubies, uint16_t slice) {
+    int remaining = SLICE_EDGES;
+    int next_slice = FIRST_SLICE_EDGE;
+    int next_layer = 0;
+
+    for (int j = 0; j < EDGES; ++j) {
+        if (remaining > 0 && slice >= binomial(EDGES - 1 - j, remaining)) {
+            slice -= binomial(EDGES - 1 - j, remaining);
+            cubies->edges[j] = next_slice++;
+            --remaining;
+        } else {
+            cubies->edges[j] = next_layer++;
+        }
+    }
+}
+
+static void set_corner_permutation(CubieState *cubies, uint16_t permutation) {
+    uint8_t values[CORNERS];
+    permutation_unrank(permutation, values, CORNERS);
+    for (int i = 0; i < CORNERS; ++i) {
+        cubies->corners[i] = values[i];
+    }
+}
+
+static void set_edge_permutation(CubieState *cubies, uint16_t permutation) {
+    uint8_t values[LAYER_EDGES];
+    permutation_unrank(permutation, values, LAYER_EDGES);
+    for (int i = 0; i < LAYER_EDGES; ++i) {
+        cubies->edges[i] = values[i];
+    }
+}
+
+static void set_slice_permutation(CubieState *cubies, uint8_t permutation) {
+    uint8_t values[SLICE_EDGES];
+    permutation_unrank(permutation, values, SLICE_EDGES);
+    for (int i = 0; i < SLICE_EDGES; ++i) {
+        cubies->edges[FIRST_SLICE_EDGE + i] = FIRST_SLICE_EDGE + values[i];
+    }
+}
+
+// Fill the move tables by setting each coordinate on a solved cube and reading it back after every movement.
+static void build_move_tables(void) {
+    CubieState cubies, moved;
+
+    for (uint16_t twist = 0; twist < TWISTS; ++twist) {
+        cubies = SOLVED_CUBIES;
+        set_twist(&cubies, twist);
+        for (size_t move = 0; move < MOVES; ++move) {
+            moved = apply_cubie_movement(&cubies, movement_from_index(move));
+            twist_moves[twist][move] = twist_coordinate(&moved);
+        }
+    }
+
+    for (uint16_t flip = 0; flip < FLIPS; ++flip) {
+        cubies = SOLVED_CUBIES;
+        set_flip(&cubies, flip);
+        for (size_t move = 0; move < MOVES; ++move) {
+            moved = apply_cubie_movement(&cubies, movement_from_index(move));
+            flip_moves[flip][move] = flip_coordinate(&moved);
+        }
+    }
+
+    for (uint16_t slice = 0; slice < SLICES; ++slice) {
+        cubies = SOLVED_CUBIES;
+        set_slice(&cubies, slice);
+        for (size_t move = 0; move < MOVES; ++move) {
+            moved = apply_cubie_movement(&cubies, movement_from_index(move));
+            slice_moves[slice][move] = slice_coordinate(&moved);
+        }
+    }
+
+    for (uint16_t permutation = 0; permutation < CORNER_PERMUTATIONS; ++permutation) {
+        cubies = SOLVED_CUBIES;
+        set_corner_permutation(&cubies, permutation);
+        for (size_t move = 0; move < PHASE_2_MOVES; ++move) {
+            moved = apply_cubie_movement(&cubies, movement_from_index(PHASE_2_MOVEMENTS[move]));
+            corner_permutation_moves[permutation][move] = corner_permutation_coordinate(&moved);
+        }
+    }
+
+    for (uint16_t permutation = 0; permutation < EDGE_PERMUTATIONS; ++permutation) {
+        cubies = SOLVED_CUBIES;
+        set_edge_permutation(&cubies, permutation);
+        for (size_t move = 0; move < PHASE_2_MOVES; ++move) {
+            moved = apply_cubie_movement(&cubies, movement_from_index(PHASE_2_MOVEMENTS[move]));
+            edge_permutation_moves[permutation][move] = edge_permutation_coordinate(&moved);
+        }
+    }
+
+    for (uint8_t permutation = 0; permutation < SLICE_PERMUTATIONS; ++permutation) {
+        cubies = SOLVED_CUBIES;
+        set_slice_permutation(&cubies, permutation);
+        for (size_t move = 0; move < PHASE_2_MOVES; ++move) {
+            moved = apply_cubie_movement(&cubies, movement_from_index(PHASE_2_MOVEMENTS[move]));
+            slice_permutation_moves[permutation][move] = slice_permutation_coordinate(&moved);
+        }
+    }
+}
+
+/*
+ * Fill a pruning table over a pair of coordinates with the distance of each pair from (0, 0),
+ * by a breadth first search through the move tables. The table is indexed by first * seconds + second.
+ * The queue must have room for every entry.
+ */
+static void build_pruning_table(uint8_t *distances, uint32_t *queue,
+                                const uint16_t *first_moves, uint32_t firsts,
+                                const void *second_moves, bool narrow_seconds, uint32_t seconds,
+                                size_t moves) {
+    size_t head = 0u, tail = 0u;
+
+    memset(distances, UNREACHED, firsts * seconds);
+    distances[0] = 0u;
+    queue[tail++] = 0u;
+
+    while (head < tail) {
+        uint32_t index = queue[head++];
+        uint32_t first = index / seconds;
+        uint32_t second = index % seconds;
+
+        for (size_t move = 0; move < moves; ++move) {
+            uint32_t next_second = narrow_seconds
+                ? ((const uint8_t *) second_moves)[second * moves + move]
+                : ((const uint16_t *) second_moves)[second * moves + move];
+            uint32_t next = first_moves[first * moves + move] * seconds + next_second;
+
+            if (distances[next] == UNREACHED) {
+                distances[next] = distances[index] + 1u;
+                queue[tail++] = next;
+            }
+        }
+    }
+}
+
+static void release_tables(void) {
+    free(twist_moves);
+    free(flip_moves);
+    free(slice_moves);
+    free(corner_permutation_moves);
+    free(edge_permutation_moves);
+    free(slice_permutation_moves);
+    free(twist_slice_distances);
+    free(flip_slice_distances);
+    free(corner_slice_distances);
+    free(edge_slice_distances);
+
+    twist_moves = NULL;
+    flip_moves = NULL;
+    slice_moves = NULL;
+    corner_permutation_moves = NULL;
+    edge_permutation_moves = NULL;
+    slice_permutation_moves = NULL;
+    twist_slice_distances = NULL;
+    flip_slice_distances = NULL;
+    corner_slice_distances = NULL;
+    edge_slice_distances = NULL;
+
+    tables_ready = false;
+}
+
+static bool build_tables(void) {
+    if (tables_ready) {
+        return true;
+    }
+
+    twist_moves = malloc(TWISTS * sizeof(*twist_moves));
+    flip_moves = malloc(FLIPS * sizeof(*flip_moves));
+    slice_moves = malloc(SLICES * sizeof(*slice_moves));
+    corner_permutation_moves = malloc(CORNER_PERMUTATIONS * sizeof(*corner_permutation_moves));
+    edge_permutation_moves = malloc(EDGE_PERMUTATIONS * sizeof(*edge_permutation_moves));
+    slice_permutation_moves = malloc(SLICE_PERMUTATIONS * sizeof(*slice_permutation_moves));
+
+    twist_slice_distances = malloc(TWISTS * SLICES);
+    flip_slice_distances = malloc(FLIPS * SLICES);
+    corner_slice_distances = malloc(CORNER_PERMUTATIONS * SLICE_PERMUTATIONS);
+    edge_slice_distances = malloc(EDGE_PERMUTATIONS * SLICE_PERMUTATIONS);
+
+    // The largest table, twist by slice, bounds the breadth first search queue.
+    uint32_t *queue = malloc(TWISTS * SLICES * sizeof(uint32_t));
+
+    if (!twist_moves || !flip_moves || !slice_moves
+            || !corner_permutation_moves || !edge_permutation_moves || !slice_permutation_moves
+            || !twist_slice_distances || !flip_slice_distances
+            || !corner_slice_distances || !edge_slice_distances || !queue) {
+        fprintf(stderr, "Failed to allocate two-phase tables.\n");
+        free(queue);
+        release_tables();
+        return false;
+    }
+
+    build_move_tables();
+
+    build_pruning_table(twist_slice_distances, queue, &twist_moves[0][0], TWISTS,
+                        &slice_moves[0][0], false, SLICES, MOVES);
+    build_pruning_table(flip_slice_distances, queue, &flip_moves[0][0], FLIPS,
+                        &slice_moves[0][0], false, SLICES, MOVES);
+    build_pruning_table(corner_slice_distances, queue, &corner_permutation_moves[0][0], CORNER_PERMUTATIONS,
+                        &slice_permutation_moves[0][0], true, SLICE_PERMUTATIONS, PHASE_2_MOVES);
+    build_pruning_table(edge_slice_distances, queue, &edge_permutation_moves[0][0], EDGE_PERMUTATIONS,
+                        &slice_permutation_moves[0][0], true, SLICE_PERMUTATIONS, PHASE_2_MOVES);
+
+    free(queue);
+    tables_ready = true;
+
+    return true;
+}
+
+bool init_twophase_tables(void) {
+    pthread_mutex_lock(&tables_lock);
+    bool ready = build_tables();
+    pthread_mutex_unlock(&tables_lock);
+
+    return ready;
+}
+
+void free_twophase_tables(void) {
+    pthread_mutex_lock(&tables_lock);
+    release_tables();
+    pthread_mutex_unlock(&tables_lock);
+}
+
+/*
+ * State of one two-phase search. moves holds the movement indices of phase 1 followed by phase 2.
+ * An anytime search keeps going after each solution with max_length one shorter,
+ * until it runs out of lengths, the callback asks it to stop, or the deadline passes.
+ */
+typedef struct {
+    CubieState start;
+    int max_length;
+    int length;
+    uint8_t moves[MAXIMUM_MOVEMENTS];
+
+    bool anytime;
+    SolutionCallback callback;
+    void *context;
+    const struct timespec *deadline;
+    uint32_t nodes;
+    bool found;
+    bool stopped;
+    uint8_t best[MAXIMUM_MOVEMENTS];
+} TwoPhaseSearch;
+
+static inline uint8_t max_distance(uint8_t a, uint8_t b) {
+    return a > b ? a : b;
+}
+
+static uint32_t allowed_after(const TwoPhaseSearch *search, int depth) {
+    return CANONICAL_MOVES[depth ? search->moves[depth - 1] / 3u : FACES];
+}
+
+// Count a node, and stop an anytime search once it has a solution and its deadline has passed.
+static bool out_of_time(TwoPhaseSearch *search) {
+    if (!search->deadline || !search->found || ++search->nodes % DEADLINE_INTERVAL != 0u) {
+        return search->stopped;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > search->deadline->tv_sec
+            || (now.tv_sec == search->deadline->tv_sec && now.tv_nsec >= search->deadline->tv_nsec)) {
+        search->stopped = true;
+    }
+
+    return search->stopped;
+}
+
+// Keep the solution in moves. An anytime search reports it and goes on looking for a shorter one.
+static bool record_solution(TwoPhaseSearch *search, int length) {
+    search->length = length;
+    search->found = true;
+    memcpy(search->best, search->moves, length);
+
+    if (!search->anytime) {
+        return true;
+    }
+
+    if (search->callback) {
+        Movement solution[MAXIMUM_MOVEMENTS];
+        for (int i = 0; i < length; ++i) {
+            solution[i] = movement_from_index(search->best[i]);
+        }
+        if (!search->callback(length, solution, search->context)) {
+            search->stopped = true;
+        }
+    }
+    search->max_length = length - 1;
+
+    return false;
+}
+
+// Search phase 2 for exactly togo more movements. Never allocates or copies cube states.
+static bool search_phase_2(TwoPhaseSearch *search, uint16_t corners, uint16_t edges, uint8_t slice,
+                           int depth, int togo) {
+    if (togo == 0) {
+        return corners == 0u && edges == 0u && slice == 0u;
+    }
+    if (out_of_time(search)) {
+        return false;
+    }
+
+    uint32_t allowed = allowed_after(search, depth);
+
+    for (size_t move = 0; move < PHASE_2_MOVES; ++move) {
+        if (!(allowed >> PHASE_2_MOVEMENTS[move] & 1u)) continue;
+
+        uint16_t next_corners = corner_permutation_moves[corners][move];
+        uint16_t next_edges = edge_permutation_moves[edges][move];
+        uint8_t next_slice = slice_permutation_moves[slice][move];
+
+        uint8_t h = max_distance(corner_slice_distances[next_corners * SLICE_PERMUTATIONS + next_slice],
+                                 edge_slice_distances[next_edges * SLICE_PERMUTATIONS + next_slice]);
+        if (h >= togo) continue;
+
+        search->moves[depth] = PHASE_2_MOVEMENTS[move];
+        if (search_phase_2(search, next_corners, next_edges, next_slice, depth + 1, togo - 1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Having reached G1 after depth movements, try to finish within the remaining length.
+static bool start_phase_2(TwoPhaseSearch *search, int depth) {
+    CubieState cubies = search->start;
+    for (int i = 0; i < depth; ++i) {
+        cubies = apply_cubie_movement(&cubies, movement_from_index(search->moves[i]));
+    }
+
+    uint16_t corners = corner_permutation_coordinate(&cubies);
+    uint16_t edges = edge_permutation_coordinate(&cubies);
+    uint8_t slice = slice_permutation_coordinate(&cubies);
+
+    uint8_t h = max_distance(corner_slice_distances[corners * SLICE_PERMUTATIONS + slice],
+                             edge_slice_distances[edges * SLICE_PERMUTATIONS + slice]);
+
+    for (int bound = h; bound <= search->max_length - depth && !search->stopped; ++bound) {
+        if (search_phase_2(search, corners, edges, slice, depth, bound)) {
+            return record_solution(search, depth + bound);
+        }
+    }
+
+    return false;
+}
+
+// A phase 1 movement that leaves G1 is a quarter turn of a side face.
+static bool leaves_g1(uint8_t move) {
+    Movement movement = movement_from_index(move);
+    return movement.face != TOP && movement.face != BOTTOM && movement.direction != DOUBLE;
+}
+
+// Search phase 1 for sequences of exactly togo more movements ending in G1, then try phase 2 from each.
+static bool search_phase_1(TwoPhaseSearch *search, uint16_t twist, uint16_t flip, uint16_t slice,
+                           int depth, int togo) {
+    if (out_of_time(search) || depth + togo > search->max_length) {
+        return false;
+    }
+    if (togo == 0) {
+        // If the last movement stayed within G1, a shorter phase 1 already reached this state.
+        if (depth > 0 && !leaves_g1(search->moves[depth - 1])) {
+            return false;
+        }
+        return start_phase_2(search, depth);
+    }
+
+    uint32_t allowed = allowed_after(search, depth);
+
+    for (size_t move = 0; move < MOVES; ++move) {
+        if (!(allowed >> move & 1u)) continue;
+
+        uint16_t next_twist = twist_moves[twist][move];
+        uint16_t next_flip = flip_moves[flip][move];
+        uint16_t next_slice = slice_moves[slice][move];
+
+        uint8_t h = max_distance(twist_slice_distances[next_twist * SLICES + next_slice],
+                                 flip_slice_distances[next_flip * SLICES + next_slice]);
+        if (h >= togo) continue;
+
+        search->moves[depth] = move;
+        if (search_phase_1(search, next_twist, next_flip, next_slice, depth + 1, togo - 1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Try phase 1 lengths in turn, up to the search's max_length, which an anytime search lowers as it goes.
+static bool run_search(TwoPhaseSearch *search, int *move_count, Movement *solution) {
+    if (!init_twophase_tables()) {
+        return false;
+    }
+
+    if (search->max_length > MAXIMUM_MOVEMENTS) {
+        search->max_length = MAXIMUM_MOVEMENTS;
+    }
+
+    uint16_t twist = twist_coordinate(&(search->start));
+    uint16_t flip = flip_coordinate(&(search->start));
+    uint16_t slice = slice_coordinate(&(search->start));
+
+    uint8_t h = max_distance(twist_slice_distances[twist * SLICES + slice],
+                             flip_slice_distances[flip * SLICES + slice]);
+
+    for (int length = h; length <= search->max_length && !search->stopped; ++length) {
+        if (search_phase_1(search, twist, flip, slice, 0, length)) {
+            break;
+        }
+    }
+
+    if (search->found) {
+        *move_count = search->length;
+        for (int i = 0; i < search->length; ++i) {
+            solution[i] = movement_from_index(search->best[i]);
+        }
+    }
+
+    return search->found;
+}
+
+bool twophase_solve_cubies(const CubieState *start, int max_length, int *move_count, Movement *solution) {
+    TwoPhaseSearch search = { .start = *start, .max_length = max_length };
+
+    return run_search(&search, move_count, solution);
+}
+
+bool twophase_solve(CubeState *start, int *move_count, Movement *solution) {
+    CubieState cubies;
+
+    if (!cubies_from_state(start, &cubies)) {
+        return false;
+    }
+
+    return twophase_solve_cubies(&cubies, MAXIMUM_MOVEMENTS, move_count, solution);
+}
+
+bool solve_with_budget(CubeState *start, const struct timespec *deadline, SolutionCallback callback, void *context,
+                       int *move_count, Movement *solution) {
+    TwoPhaseSearch search = {
+        .max_length = MAXIMUM_MOVEMENTS,
+        .anytime = true,
+        .callback = callback,
+        .context = context,
+        .deadline = deadline
+    };
+
+    if (!cubies_from_state(start, &(search.start))) {
+        return false;
+    }
+
+    return run_search(&search, move_count, solution);
+}
@@ -0,0 +1,157 @@
+#ifndef __TWOPHASE_H__
+#define __TWOPHASE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "cubestate.h"
+
+/*
+ * Kociemba's two-phase algorithm over cubie coordinates.
+ *
+ * Phase 1 brings the cube into G1 = <U, D, R2, L2, F2, B2>, where every corner and edge is oriented
+ * and the four middle layer edges are in the middle layer. Phase 2 solves the cube using only G1 movements.
+ * Each phase is an IDA* search over small integer coordinates, using move tables to apply movements
+ * and pruning tables of exact distances over pairs of coordinates as an admissible heuristic.
+ */
+
+// Number of values of each phase 1 coordinate.
+#define TWISTS 2187
+#define FLIPS  2048
+#define SLICES 495
+
+// Number of values of each phase 2 coordinate.
+#define CORNER_PERMUTATIONS 40320
+#define EDGE_PERMUTATIONS   40320
+#define SLICE_PERMUTATIONS  24
+
+// Number of movements that keep a cube within G1.
+#define PHASE_2_MOVES 10
+
+/**
+ * Movement indices of the movements allowed in phase 2, in the order their move tables use.
+ */
+static const uint8_t PHASE_2_MOVEMENTS[PHASE_2_MOVES] = {
+    TOP * 3 + CW, TOP * 3 + DOUBLE, TOP * 3 + CCW,
+    FRONT * 3 + DOUBLE, LEFT * 3 + DOUBLE, BACK * 3 + DOUBLE, RIGHT * 3 + DOUBLE,
+    BOTTOM * 3 + CW, BOTTOM * 3 + DOUBLE, BOTTOM * 3 + CCW
+};
+
+/**
+ * Receives each solution solve_with_budget finds, each shorter than the one before.
+ *
+ * @param  move_count The number of moves in the solution.
+ * @param  solution   An array of moves which transform the start to a solved cube.
+ * @param  context    The context given to solve_with_budget.
+ * @return            True to keep looking for a shorter solution, false to stop with this one.
+ */
+typedef bool (*SolutionCallback)(int move_count, const Movement *solution, void *context);
+
+/**
+ * Get the corner orientation coordinate, from the twists of the first seven corners.
+ *
+ * @param  cubies Cube to read.
+ * @return        The coordinate, 0 to TWISTS - 1. Zero when every corner is oriented.
+ */
+uint16_t twist_coordinate(const CubieState *cubies);
+
+/**
+ * Get the edge orientation coordinate, from the flips of the first eleven edges.
+ *
+ * @param  cubies Cube to read.
+ * @return        The coordinate, 0 to FLIPS - 1. Zero when every edge is oriented.
+ */
+uint16_t flip_coordinate(const CubieState *cubies);
+
+/**
+ * Get the coordinate of which positions hold the four middle layer edges, ignoring their order.
+ *
+ * @param  cubies Cube to read.
+ * @return        The coordinate, 0 to SLICES - 1. Zero when they are all in the middle layer.
+ */
+uint16_t slice_coordinate(const CubieState *cubies);
+
+/**
+ * Get the permutation coordinate of the corners.
+ *
+ * @param  cubies Cube to read.
+ * @return        The coordinate, 0 to CORNER_PERMUTATIONS - 1. Zero when every corner is in place.
+ */
+uint16_t corner_permutation_coordinate(const CubieState *cubies);
+
+/**
+ * Get the permutation coordinate of the top and bottom layer edges.
+ * Only meaningful in G1, where those edges are all in the top and bottom layers.
+ *
+ * @param  cubies Cube to read.
+ * @return        The coordinate, 0 to EDGE_PERMUTATIONS - 1. Zero when those edges are in place.
+ */
+uint16_t edge_permutation_coordinate(const CubieState *cubies);
+
+/**
+ * Get the permutation coordinate of the middle layer edges.
+ * Only meaningful in G1, where those edges are all in the middle layer.
+ *
+ * @param  cubies Cube to read.
+ * @return        The coordinate, 0 to SLICE_PERMUTATIONS - 1. Zero when those edges are in place.
+ */
+uint8_t slice_permutation_coordinate(const CubieState *cubies);
+
+/**
+ * Build the move and pruning tables.
+ * This takes a moment and around 6MB, and is done by the first solve if not called beforehand.
+ * Safe to call from several threads at once.
+ *
+ * @return True if the tables are ready. False if they could not be allocated.
+ */
+bool init_twophase_tables(void);
+
+/**
+ * Free the tables built by init_twophase_tables.
+ * Solving again builds them again. No solve may be running while they are freed.
+ */
+void free_twophase_tables(void);
+
+/**
+ * Finds a solution of at most max_length movements for a cube given by its cubies.
+ * Phase 1 solutions are tried in order of length, so longer limits give answers sooner.
+ *
+ * @param[in]  start      The starting position.
+ * @param[in]  max_length The most movements the solution may have, at most MAXIMUM_MOVEMENTS.
+ * @param[out] move_count The number of moves in the solution.
+ * @param[out] solution   An array of moves which transform start to a solved cube.
+ * @return                True if a solution was found.
+ */
+bool twophase_solve_cubies(const CubieState *start, int max_length, int *move_count, Movement *solution);
+
+/**
+ * Finds a solution of at most MAXIMUM_MOVEMENTS movements using the two-phase algorithm.
+ *
+ * @param[in]  start      The starting position.
+ * @param[out] move_count The number of moves in the solution.
+ * @param[out] solution   An array of moves which transform start to a solved cube.
+ * @return                True if a solution was found. False if start is not a valid cube.
+ */
+bool twophase_solve(CubeState *start, int *move_count, Movement *solution);
+
+/**
+ * Finds a solution quickly using the two-phase algorithm, then keeps looking for shorter ones until a deadline.
+ * Each solution found is passed to callback as soon as it is found. The first is found in milliseconds
+ * once the tables are built, and is searched for whatever the deadline.
+ * Every phase 1 length is tried up to one less than the best solution so far, so a search that
+ * runs out of lengths before the deadline has found a shortest solution.
+ *
+ * @param[in]  start      The starting position.
+ * @param[in]  deadline   When to stop looking, on CLOCK_MONOTONIC. NULL to look until a shortest solution is found.
+ * @param[in]  callback   Called with each solution found, or NULL.
+ * @param[in]  context    Passed on to callback.
+ * @param[out] move_count The number of moves in the shortest solution found.
+ * @param[out] solution   An array of moves which transform start to a solved cube.
+ * @return                True if a solution was found. False if start is not a valid cube.
+ */
+bool solve_with_budget(CubeState *start, const struct timespec *deadline, SolutionCallback callback, void *context,
+                       int *move_count, Movement *solution);
+
+#endif  // __TWOPHASE_H__
@@ -0,0 +1,226 @@
+#include "weighted_star.h"
+#include "hashset.h"
+#include "movequeue.h"
+#include "movetrail.h"
+
+#include <stdlib.h>
+
+// Open lists of focal_solve, one for each depth + estimate. Larger sums, which no admissible
+// estimate gives, share the last.
+#define FOCAL_BUCKETS (4 * MAXIMUM_MOVEMENTS)
+
+/*
+ * What both searches keep besides their open states.
+ */
+typedef struct {
+    const Heuristic *heuristic; /**< Heuristic bounding the solution length. */
+    const Heuristic *guide;     /**< Heuristic focal_solve picks states by, or NULL to use heuristic. */
+    const SolveLimits *limits;  /**< Bounds on the search, or NULL for none. */
+    HashSet *closed;            /**< Key of each state expanded, with the fewest movements it was reached in. */
+    MoveTrail *trail;           /**< Links of the states expanded. */
+    uint64_t expanded;          /**< Number of states expanded. */
+    SolveResult result;         /**< Why the search stopped. */
+} BoundedSearch;
+
+/*
+ * Children of an expanded state worth queuing, with their estimates.
+ */
+typedef struct {
+    int count;
+    CubeState states[MOVES];
+    PathLink links[MOVES];
+    int estimates[MOVES];
+    int guides[MOVES];
+} Children;
+
+static bool begin_search(BoundedSearch *search, const Heuristic *heuristic, const Heuristic *guide,
+                         const SolveLimits *limits) {
+    search->heuristic = heuristic;
+    search->guide = guide;
+    search->limits = limits;
+    search->closed = new_hash_set(100);
+    search->trail = new_move_trail(100);
+    search->expanded = 0;
+    search->result = SOLVE_NOT_FOUND;
+    return search->closed && search->trail;
+}
+
+static void end_search(BoundedSearch *search) {
+    free_move_trail(search->trail);
+    free_hash_set(search->closed);
+}
+
+// Whether a state was already expanded through a path at most depth movements long.
+static bool closed_within(BoundedSearch *search, StateKey key, int depth) {
+    ssize_t *closed = get_offset_from_hash_set(search->closed, key);
+    return closed && *closed <= depth;
+}
+
+/*
+ * Expand a node taken from the open states, unless it was already expanded through a path at least as
+ * short. Afterwards children holds those of its children not already expanded at least as cheaply.
+ *
+ * @return True while the search goes on. Otherwise search->result tells why it stopped.
+ */
+static bool expand(BoundedSearch *search, const MoveQueueNode *node, size_t queued, Children *children,
+                   int *move_count, Movement *solution) {
+    children->count = 0;
+    if (closed_within(search, node->key, node->link.depth)) {
+        return true;
+    }
+    if (!query_hash_set(search->closed, node->key) && !add_to_hash_set(search->closed, node->key)) {
+        return false;
+    }
+    modify_offset_in_hash_set(search->closed, node->key, node->link.depth);
+
+    CubeState state = node->state;
+    if (solved(&state)) {
+        *move_count = trace_moves(search->trail, node->link, solution);
+        search->result = SOLVE_FOUND;
+        return false;
+    }
+
+    size_t bytes = queued * sizeof(MoveQueueNode) + search->closed->size * sizeof(SetEntry)
+                   + search->trail->size * sizeof(PathLink);
+    if (solve_limit_reached(search->limits, search->expanded++, bytes, &(search->result))) {
+        return false;
+    }
+    if (node->link.depth == MAXIMUM_MOVEMENTS) {
+        return true;
+    }
+
+    // The start state needs no link of its own.
+    PathLink link = { .parent = NO_PARENT, .depth = node->link.depth + 1 };
+    if (node->link.depth > 0 && !add_to_move_trail(search->trail, node->link, &link.parent)) {
+        return false;
+    }
+
+    CubeState next[MOVES];
+    HeuristicTally tally;
+    HeuristicTally guide_tally;
+    HeuristicTally child;
+    uint32_t allowed = moves_after(node->link);
+    apply_all_movements_to_faces(&state, next);
+
+    heuristic_tally(search->heuristic, &state, &tally);
+    if (search->guide) {
+        heuristic_tally(search->guide, &state, &guide_tally);
+    }
+    for (size_t move = 0; move < MOVES; move++) {
+        if (!(allowed >> move & 1u) || closed_within(search, cubestate_key(&next[move]), link.depth)) continue;
+
+        int i = children->count++;
+        link.move = movement_from_index(move);
+        children->states[i] = next[move];
+        children->links[i] = link;
+        children->estimates[i] = heuristic_update(search->heuristic, &tally, link.move, &next[move], &child);
+        children->guides[i] = search->guide
+            ? heuristic_update(search->guide, &guide_tally, link.move, &next[move], &child)
+            : children->estimates[i];
+    }
+    return true;
+}
+
+SolveResult weighted_solve(CubeState *start, const Heuristic *heuristic, double weight, const SolveLimits *limits,
+                           int *move_count, Movement *solution) {
+    BoundedSearch search;
+    MovePriorityQueue *open = new_move_priority_queue(100);
+    MoveQueueNode node;
+    Children children;
+
+    if (weight < 1.0) {
+        weight = 1.0;
+    }
+
+    if (begin_search(&search, heuristic, NULL, limits) && open) {
+        bool added = add_to_move_priority_queue(open, start, START_LINK, weight * heuristic_estimate(heuristic, start));
+
+        // A child dropped for want of memory could break the bound, so the search stops instead.
+        while (added && poll_move_priority_queue(open, &node)
+                && expand(&search, &node, open->count, &children, move_count, solution)) {
+            for (int i = 0; added && i < children.count; i++) {
+                double cost = children.links[i].depth + weight * children.estimates[i];
+                added = add_to_move_priority_queue(open, &children.states[i], children.links[i], cost);
+            }
+        }
+    }
+
+    free_move_priority_queue(open);
+    end_search(&search);
+
+    return search.result;
+}
+
+// Queue a state for focal_solve in the open list of its depth + estimate, ordered by the guide's estimate.
+static bool add_to_focal(MovePriorityQueue **open, int *lowest, const CubeState *state, PathLink link,
+                         int estimate, int guide) {
+    int bucket = link.depth + estimate < FOCAL_BUCKETS ? link.depth + estimate : FOCAL_BUCKETS - 1;
+    if (!open[bucket] && !(open[bucket] = new_move_priority_queue(100))) {
+        return false;
+    }
+    if (bucket < *lowest) {
+        *lowest = bucket;
+    }
+    return add_to_move_priority_queue(open[bucket], state, link, guide);
+}
+
+// Poll the state the guide prefers of those whose depth + estimate is at most bound times the smallest.
+static bool poll_focal(MovePriorityQueue **open, int *lowest, double bound, MoveQueueNode *node, size_t *queued) {
+    while (*lowest < FOCAL_BUCKETS && !(open[*lowest] && open[*lowest]->count > 0)) {
+        (*lowest)++;
+    }
+    if (*lowest == FOCAL_BUCKETS) {
+        return false;
+    }
+
+    // A tiny allowance keeps products like 1.2 * 5 from rounding below a whole number.
+    int within = (int) (bound * *lowest + 1e-9);
+    MovePriorityQueue *best = open[*lowest];
+    *queued = 0;
+    for (int bucket = *lowest; bucket < FOCAL_BUCKETS; bucket++) {
+        if (!open[bucket] || open[bucket]->count == 0) continue;
+
+        *queued += open[bucket]->count;
+        if (bucket <= within && open[bucket]->heap[0].cost < best->heap[0].cost) {
+            best = open[bucket];
+        }
+    }
+    (*queued)--;
+    return poll_move_priority_queue(best, node);
+}
+
+SolveResult focal_solve(CubeState *start, const Heuristic *heuristic, const Heuristic *guide, double bound,
+                        const SolveLimits *limits, int *move_count, Movement *solution) {
+    BoundedSearch search;
+    MovePriorityQueue *open[FOCAL_BUCKETS] = { NULL };
+    int lowest = FOCAL_BUCKETS;
+    size_t queued = 0;
+    MoveQueueNode node;
+    Children children;
+
+    if (bound < 1.0) {
+        bound = 1.0;
+    }
+
+    if (begin_search(&search, heuristic, guide, limits)) {
+        int h = heuristic_estimate(heuristic, start);
+        bool added = add_to_focal(open, &lowest, start, START_LINK, h, guide ? heuristic_estimate(guide, start) : h);
+
+        while (added && poll_focal(open, &lowest, bound, &node, &queued)
+                && expand(&search, &node, queued, &children, move_count, solution)) {
+            for (int i = 0; added && i < children.count; i++) {
+                added = add_to_focal(open, &lowest, &children.states[i], children.links[i],
+                                     children.estimates[i], children.guides[i]);
+            }
+        }
+    }
+
+    for (int bucket = 0; bucket < FOCAL_BUCKETS; bucket++) {
+        if (open[bucket]) {
+            free_move_priority_queue(open[bucket]);
+        }
+    }
+    end_search(&search);
+
+    return search.result;
+}
@@ -0,0 +1,49 @@
+#ifndef __WEIGHTED_STAR_H__
+#define __WEIGHTED_STAR_H__
+
+#include "cubestate.h"
+#include "heuristic.h"
+#include "solvelimits.h"
+
+/*
+ * Best-first searches which trade a bounded amount of solution length for speed.
+ *
+ * Weighted A* expands states in order of depth + weight * estimate. Focal search keeps the open states
+ * whose depth + estimate is within a factor of the smallest, and of those expands the one a guide
+ * heuristic thinks is nearest the goal. Either way, a state reached again through a shorter path is
+ * expanded again, so that with an admissible heuristic the solution found is at most the weight or
+ * factor times as long as a shortest one. Weights and factors below 1 are taken as 1. If a state
+ * cannot be queued for want of memory, the search stops rather than break the bound. Without an
+ * admissible heuristic nothing is promised.
+ */
+
+/**
+ * Finds a solution set of moves for a cube with weighted A*.
+ *
+ * @param[in]   start       The starting position.
+ * @param[in]   heuristic   Heuristic to estimate with.
+ * @param[in]   weight      Weight of the estimate against the depth, 1 or more.
+ * @param[in]   limits      Bounds on the search, or NULL for none.
+ * @param[out]  move_count  The number of moves in the solution.
+ * @param[out]  solution    An array of moves which transform start to a solved cube.
+ * @return                  SOLVE_FOUND if a solution was found, otherwise why not.
+ */
+SolveResult weighted_solve(CubeState *start, const Heuristic *heuristic, double weight, const SolveLimits *limits,
+                           int *move_count, Movement *solution);
+
+/**
+ * Finds a solution set of moves for a cube with focal search.
+ *
+ * @param[in]   start       The starting position.
+ * @param[in]   heuristic   Heuristic bounding the solution length.
+ * @param[in]   guide       Heuristic picking among the states within the bound, or NULL to use heuristic.
+ * @param[in]   bound       Factor the solution may be longer than a shortest one by, 1 or more.
+ * @param[in]   limits      Bounds on the search, or NULL for none.
+ * @param[out]  move_count  The number of moves in the solution.
+ * @param[out]  solution    An array of moves which transform start to a solved cube.
+ * @return                  SOLVE_FOUND if a solution was found, otherwise why not.
+ */
+SolveResult focal_solve(CubeState *start, const Heuristic *heuristic, const Heuristic *guide, double bound,
+                        const SolveLimits *limits, int *move_count, Movement *solution);
+
+#endif  // __WEIGHTED_STAR_H__